@@ -1,15 +1,18 @@
 #include "Ball.h"
-#include <Arduino.h> // For millis()
+#include <Arduino.h> // For micros()
 
 
 Ball::Ball(lv_obj_t* parent, float start_x, float start_y, float radius) {
-    x = start_x;
-    y = start_y;
-    velocity_x = 0.0f;
-    velocity_y = 0.0f;
-    this->radius = radius;
-    last_update_ms = millis();
+    x = BallScalar(start_x);
+    y = BallScalar(start_y);
+    velocity_x = BallScalar(0.0f);
+    velocity_y = BallScalar(0.0f);
+    prev_x = x;
+    prev_y = y;
+    this->radius = BallScalar(radius);
+    clock.restart(micros());
 
+#if MAZE_BALL_OBJECT
     // Create the LVGL object for the ball
     obj = lv_obj_create(parent);
     lv_obj_set_size(obj, radius * 2, radius * 2);
@@ -20,44 +23,140 @@ Ball::Ball(lv_obj_t* parent, float start_x, float start_y, float radius) {
     lv_style_set_radius(&style_ball, LV_RADIUS_CIRCLE);
     lv_style_set_border_width(&style_ball, 0);
     lv_obj_add_style(obj, &style_ball, 0);
+#else
+    // Drawn on top of the parent and all its children (walls, hint dots)
+    obj = parent;
+    lv_obj_add_event_cb(obj, drawEvent, LV_EVENT_DRAW_POST, this);
+    lv_obj_add_event_cb(obj, deleteEvent, LV_EVENT_DELETE, this);
+#endif
     
     draw(); // Draw initial position
 }
 
 
+Ball::~Ball() {
+    if (!obj) return;
+#if MAZE_BALL_OBJECT
+    lv_obj_del(obj);
+#else
+    // the parent lives on, wipe the ball off it and unhook the callbacks
+    invalidate(drawn);
+    lv_obj_remove_event_cb_with_user_data(obj, drawEvent, this);
+    lv_obj_remove_event_cb_with_user_data(obj, deleteEvent, this);
+#endif
+    obj = nullptr;
+}
+
+
 void Ball::updatePhysics(float roll, float pitch) {
+    prev_x = x;
+    prev_y = y;
+    step_pending = true;
+
     // Acceleration is proportional to the tilt
-    const float gravity_factor = 0.05f;
-    velocity_x += -pitch * gravity_factor;
-    velocity_y += -roll * gravity_factor;
+    velocity_x += clock.tiltAccel(pitch);
+    velocity_y += clock.tiltAccel(roll);
 
     // Apply some friction to slow the ball down over time
-    const float friction = 0.98f;
-    velocity_x *= friction;
-    velocity_y *= friction;
+    velocity_x *= clock.friction();
+    velocity_y *= clock.friction();
 }
 
 
 void Ball::draw() {
-    // Update the on-screen object's position
-    lv_obj_set_pos(obj, (lv_coord_t)(x - radius), (lv_coord_t)(y - radius));
+    // somewhere between the last two steps, by how far the clock is into the next one
+    const BallScalar alpha = clock.alpha();
+    const BallScalar draw_x = prev_x + (x - prev_x) * alpha;
+    const BallScalar draw_y = prev_y + (y - prev_y) * alpha;
+
+    const lv_coord_t size = (lv_coord_t)(int)(radius * BallScalar(2));
+    lv_area_t area;
+    area.x1 = (lv_coord_t)(int)(draw_x - radius);
+    area.y1 = (lv_coord_t)(int)(draw_y - radius);
+    area.x2 = area.x1 + size - 1;
+    area.y2 = area.y1 + size - 1;
+
+    // same pixels as last frame, nothing to redraw
+    if (area.x1 == drawn.x1 && area.y1 == drawn.y1 && drawn.x2 >= drawn.x1) return;
+
+    const lv_area_t old = drawn;
+    drawn = area;
+#if MAZE_BALL_OBJECT
+    // LVGL invalidates both positions itself
+    (void)old;
+    lv_obj_set_pos(obj, area.x1, area.y1);
+    invalidated_px += 2 * (uint32_t)size * size;
+    ++invalidate_count;
+#else
+    if (old.x2 < old.x1) {
+        invalidate(area);
+        return;
+    }
+    // A ball moves a pixel or two per frame, so the squares nearly always overlap and one
+    // joined area is smaller than two. Far apart (a respawn), they are sent separately.
+    lv_area_t joined;
+    _lv_area_join(&joined, &old, &area);
+    const uint32_t joined_px = (uint32_t)lv_area_get_width(&joined) * lv_area_get_height(&joined);
+    if (joined_px <= 2 * (uint32_t)size * size) {
+        invalidate(joined);
+    } else {
+        invalidate(old);
+        invalidate(area);
+    }
+#endif
 }
 
 
-// Updates dx and xy returns true if they change, note that IMU readings are only sent if a large enough change is detected
-bool Ball::consumeDelta(float& dx, float& dy) {
-    uint32_t now = millis();
-    float time_change = (now - last_update_ms) / 1000.0f;
-    last_update_ms = now;
+void Ball::invalidate(const lv_area_t& area) {
+    if (!obj || area.x2 < area.x1) return;
+    // area is in screen coordinates, same as the parent's since it fills the screen
+    lv_obj_invalidate_area(obj, &area);
+    invalidated_px += (uint32_t)lv_area_get_width(&area) * lv_area_get_height(&area);
+    ++invalidate_count;
+}
 
-    const float scale_factor = 10.0f;
-    dx = velocity_x * time_change * scale_factor;
-    dy = velocity_y * time_change * scale_factor;
-    return (dx != 0.0f || dy != 0.0f);
+
+void Ball::drawEvent(lv_event_t* e) {
+    Ball* ball = (Ball*)lv_event_get_user_data(e);
+    lv_draw_ctx_t* draw_ctx = lv_event_get_draw_ctx(e);
+    lv_area_t clipped;
+    if (!_lv_area_intersect(&clipped, &ball->drawn, draw_ctx->clip_area)) return;
+
+    lv_draw_rect_dsc_t dsc;
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.bg_color = lv_palette_main(LV_PALETTE_GREEN);
+    dsc.bg_opa = LV_OPA_COVER;
+    dsc.radius = LV_RADIUS_CIRCLE;
+    dsc.border_width = 0;
+    lv_draw_rect(draw_ctx, &dsc, &ball->drawn);
+}
+
+
+void Ball::deleteEvent(lv_event_t* e) {
+    Ball* ball = (Ball*)lv_event_get_user_data(e);
+    ball->obj = nullptr;
 }
 
-// Actually applies movement to position
-void Ball::translate(float dx, float dy) {
-    x += dx;
-    y += dy;
+
+// Updates dx and xy returns true if they change, one fixed step worth of movement
+bool Ball::consumeDelta(BallScalar& dx, BallScalar& dy) {
+    const BallScalar zero = BallScalar(0.0f);
+    if (!step_pending) {
+        dx = dy = zero;
+        return false;
+    }
+    step_pending = false;
+    dx = clock.stepDelta(velocity_x);
+    dy = clock.stepDelta(velocity_y);
+    return (dx != zero || dy != zero);
+}
+
+#if MAZE_FIXED_POINT
+bool Ball::consumeDelta(float& dx, float& dy) {
+    BallScalar qx, qy;
+    const bool moved = consumeDelta(qx, qy);
+    dx = (float)qx;
+    dy = (float)qy;
+    return moved;
 }
+#endif
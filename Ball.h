@@ -4,7 +4,30 @@
 #define BALL_H
 
 #include <lvgl.h>
+#include <math.h>
+#include "FixedPoint.h"
+#include "PhysicsClock.h"
 
+// 1 moves an lv_obj with lv_obj_set_pos every frame like the ball used to, only meant for
+// comparing invalidated pixels and flushes against the dirty rectangle renderer
+#ifndef MAZE_BALL_OBJECT
+#define MAZE_BALL_OBJECT 0
+#endif
+
+/**
+ * @class Ball
+ * @brief The rolling ball. It is drawn by its parent's post draw callback, so draw() decides
+ * itself what gets invalidated: nothing while the pixel position stays put, otherwise the
+ * old and new squares, merged into one area when they overlap.
+ *
+ * Physics runs in fixed steps of 1 / physics rate seconds (PhysicsClock): advanceClock() turns
+ * the wall time since the last frame into a number of steps, each step is updatePhysics()
+ * followed by the maze's collision pass. The same tilt gives the same motion at any loop rate, and draw()
+ * interpolates between the last two steps so the ball doesn't judder when the rates beat.
+ *
+ * State is kept as BallScalar, float or Q16.16 with MAZE_FIXED_POINT. The float getters and
+ * setters convert, the substep kernels use posX() / velX() / ... and never leave the format.
+ */
 class Ball {
 public:
     /**
@@ -19,63 +42,178 @@ public:
     /**
      * @brief Destructor of Ball object.
     */
-    ~Ball() {
-        if (obj) {
-            lv_obj_del(obj);
-            obj = nullptr;
-        }
-    }
+    ~Ball();
+
+    // the parent's draw callback holds a pointer back to this ball
+    Ball(const Ball&) = delete;
+    Ball& operator=(const Ball&) = delete;
     
     /**
-     * @brief Applies forces from the IMU to update the ball's velocity.
+     * @brief Sets the fixed step rate, more steps cost more collision queries per second
+     */
+    void setPhysicsRate(uint16_t hz) { clock.setRate(hz); }
+    uint16_t getPhysicsRate() const { return clock.rate(); }
+
+    /**
+     * @brief Adds the time since the last call to the step accumulator
+     * @param now_us current time from micros()
+     * @return number of fixed steps to run this frame, at most PhysicsClock::MAX_STEPS_PER_FRAME
+     */
+    int advanceClock(uint32_t now_us) { return clock.advance(now_us); }
+
+    /**
+     * @brief Starts the step accumulator over at now_us instead of the micros() of construction,
+     * for a game running on SessionClock time
+     */
+    void restartClock(uint32_t now_us) { clock.restart(now_us); }
+
+    /**
+     * @brief One fixed step: applies forces from the IMU to update the ball's velocity.
      * @param roll The roll angle (tilt) in degrees.
      * @param pitch The pitch angle (tilt) in degrees.
      */
     void updatePhysics(float roll, float pitch);
     
     /**
-     * @brief Computes change in x and y dir of ball and returns true if 
-     * non zero, used for collision checking
+     * @brief Movement of the current step (velocity over one fixed step), returns true if
+     * non zero, used for collision checking. Only the first call after updatePhysics moves.
      * @param dx Change in the x direction.
      * @param dy Change in the y direction.
      */
-    bool consumeDelta(float& dx, float& dy);
+    bool consumeDelta(BallScalar& dx, BallScalar& dy);
 
     /**
      * @brief Actually moves ball by dx, dy
      * @param dx Change in the x direction.
      * @param dy Change in the y direction.
      */
-    void translate(float dx, float dy);
+    void translate(BallScalar dx, BallScalar dy) {
+        x += dx;
+        y += dy;
+    }
+
+#if MAZE_FIXED_POINT
+    // float versions for the swept, indexed and graph maze kernels, which stay in float
+    bool consumeDelta(float& dx, float& dy);
+    void translate(float dx, float dy) { translate(BallScalar(dx), BallScalar(dy)); }
+#endif
 
-    // Updates the on-screen LVGL object's position to match the internal coordinates
+    // Updates the on-screen position to match the internal coordinates (interpolated between
+    // the last two steps), only invalidates if a pixel changed
     void draw();
     
     // Getters and Setters for the Maze to use
-    float getX() const { return x; }
-    float getY() const { return y; }
-    void setX(float nx) { x = nx; }
-    void setY(float ny) { y = ny; }
-
-    float getVelocityX() const { return velocity_x; }
-    float getVelocityY() const { return velocity_y; }
-    void setVelocityX(float vx) { velocity_x = vx; }
-    void setVelocityY(float vy) { velocity_y = vy; }
-    float getRadius() const { return radius; }
-    uint32_t getLastUpdateMs() const { return last_update_ms; }
+    float getX() const { return toFloat(x); }
+    float getY() const { return toFloat(y); }
+    void setX(float nx) { x = BallScalar(nx); }
+    void setY(float ny) { y = BallScalar(ny); }
+
+    float getVelocityX() const { return toFloat(velocity_x); }
+    float getVelocityY() const { return toFloat(velocity_y); }
+    void setVelocityX(float vx) { velocity_x = BallScalar(vx); }
+    void setVelocityY(float vy) { velocity_y = BallScalar(vy); }
+    float getRadius() const { return toFloat(radius); }
+
+    // The same in the ball's own format, for the substep kernels
+    BallScalar posX() const { return x; }
+    BallScalar posY() const { return y; }
+    void setPosX(BallScalar nx) { x = nx; }
+    void setPosY(BallScalar ny) { y = ny; }
+    BallScalar velX() const { return velocity_x; }
+    BallScalar velY() const { return velocity_y; }
+    void setVelX(BallScalar vx) { velocity_x = vx; }
+    void setVelY(BallScalar vy) { velocity_y = vy; }
+    BallScalar rad() const { return radius; }
+    uint32_t getLastUpdateUs() const { return clock.lastUpdateUs(); }
+
+    // Render counters since the last resetRenderStats()
+    uint32_t invalidatedPixels() const { return invalidated_px; }
+    uint32_t invalidations() const { return invalidate_count; }
+    void resetRenderStats() { invalidated_px = 0; invalidate_count = 0; }
 
 private:
-    lv_obj_t* obj; // Pointer to the LVGL object for the ball
+    lv_obj_t* obj = nullptr; // LVGL object the ball is drawn on (its parent screen), or the ball itself
+    lv_area_t drawn = {0, 0, -1, -1}; // pixels covered on screen right now
+    uint32_t invalidated_px = 0;
+    uint32_t invalidate_count = 0;
+
+    void invalidate(const lv_area_t& area);
+    static void drawEvent(lv_event_t* e);
+    static void deleteEvent(lv_event_t* e);
 
     // State variables
-    float x;
-    float y;
-    float velocity_x;
-    float velocity_y;
-    uint32_t last_update_ms;
+    BallScalar x;
+    BallScalar y;
+    BallScalar velocity_x;
+    BallScalar velocity_y;
+    BallScalar prev_x, prev_y;     // position before the last step, for interpolation
+    bool step_pending = false;     // consumeDelta not called yet for the last step
+    PhysicsClock clock;
     
     // Properties
-    float radius = 5.0f;
+    BallScalar radius = BallScalar(5.0f);
 };
 
+/**
+ * @brief Moves ball by its pending delta in substeps of at most max_step_px, so walls can't be
+ * "tunneled" through. collide(ball) runs after every substep and is inlined by the compiler.
+ * @param ball a Ball or a BallSwarm::Body
+ * @param max_step_px substep length, <= 0 picks half the radius
+ * @param max_substeps cap on the number of substeps for one delta
+ */
+template <typename Body, typename Collide>
+inline void stepBallInSubsteps(Body& ball, float max_step_px, uint8_t max_substeps, Collide collide) {
+    BallScalar dx, dy;
+    if (!ball.consumeDelta(dx, dy)) return; // no motion this frame
+
+    // Choose a safe step length: default to half the radius
+    const BallScalar max_step = max_step_px > 0.0f ? BallScalar(max_step_px) : ball.rad() * BallScalar(0.5f);
+
+    // Determine steps based on direction of greatest change
+    BallScalar max_axis = scalarAbs(dx) > scalarAbs(dy) ? scalarAbs(dx) : scalarAbs(dy);
+    int steps = scalarCeilDiv(max_axis, max_step);
+    if (steps < 1) steps = 1;
+    if ((uint8_t)steps > max_substeps) steps = max_substeps;
+
+    BallScalar sx = dx / steps;
+    BallScalar sy = dy / steps;
+
+    for (int i = 0; i < steps; ++i) {
+        ball.translate(sx, sy);
+        collide(ball);  // clamp/reflect if we touched any wall
+    }
+}
+
+// Share of the speed into a wall a bounce keeps, going the other way. Every collision kernel bounces with it.
+static constexpr float WALL_BOUNCE = 0.25f;
+
+/**
+ * @brief Damped reflection of a velocity moving into a wall, nothing if it already moves away
+ * @param nx, ny unit normal of the wall, pointing to the side the ball is on
+ * Works on float and BallScalar.
+ */
+template <typename T>
+inline void reflectOffWall(T& vx, T& vy, T nx, T ny) {
+    const T vn = vx*nx + vy*ny;
+    if (vn < T(0.0f)) {
+        vx -= T(1.0f + WALL_BOUNCE) * vn * nx;
+        vy -= T(1.0f + WALL_BOUNCE) * vn * ny;
+    }
+}
+
+/**
+ * @brief Runs a float kernel bool(float& x, float& y, float& vx, float& vy, float radius) on a
+ * ball and writes position and velocity back if it reports a contact
+ * @param ball a Ball or a BallSwarm::Body
+ */
+template <typename Body, typename Kernel>
+inline bool collideBody(Body& ball, Kernel kernel) {
+    float x = ball.getX(), y = ball.getY();
+    float vx = ball.getVelocityX(), vy = ball.getVelocityY();
+    if (!kernel(x, y, vx, vy, ball.getRadius())) return false;
+    ball.setX(x); ball.setY(y);
+    ball.setVelocityX(vx); ball.setVelocityY(vy);
+    return true;
+}
+
 #endif // BALL_H
\ No newline at end of file
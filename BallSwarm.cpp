@@ -0,0 +1,221 @@
+#include "BallSwarm.h"
+#include <Arduino.h> // For micros()
+
+
+BallSwarm::BallSwarm(lv_obj_t* parent, int capacity, float radius)
+    : obj(parent), capacity(capacity > 255 ? 255 : capacity), radius(radius) {
+    // by_x holds indices in a byte
+    for (std::vector<BallScalar>* v : { &x, &y, &vx, &vy, &dx, &dy, &prev_x, &prev_y }) v->reserve(this->capacity);
+    by_x.reserve(this->capacity);
+    drawn.reserve(this->capacity);
+    clock.restart(micros());
+
+    lv_obj_add_event_cb(obj, drawEvent, LV_EVENT_DRAW_POST, this);
+    lv_obj_add_event_cb(obj, deleteEvent, LV_EVENT_DELETE, this);
+}
+
+
+BallSwarm::~BallSwarm() {
+    if (!obj) return;
+    // the parent lives on, wipe the balls off it and unhook the callbacks
+    for (const lv_area_t& a : drawn) invalidate(a);
+    lv_obj_remove_event_cb_with_user_data(obj, drawEvent, this);
+    lv_obj_remove_event_cb_with_user_data(obj, deleteEvent, this);
+    obj = nullptr;
+}
+
+
+int BallSwarm::add(float start_x, float start_y) {
+    if (count() >= capacity) return -1;
+    const int i = count();
+    x.push_back(BallScalar(start_x));
+    y.push_back(BallScalar(start_y));
+    prev_x.push_back(x[i]);
+    prev_y.push_back(y[i]);
+    vx.push_back(BallScalar(0.0f));
+    vy.push_back(BallScalar(0.0f));
+    dx.push_back(BallScalar(0.0f));
+    dy.push_back(BallScalar(0.0f));
+    by_x.push_back((uint8_t)i);
+    drawn.push_back({0, 0, -1, -1});
+    return i;
+}
+
+
+void BallSwarm::updatePhysics(float roll, float pitch) {
+    // the same for every ball, worked out once
+    const BallScalar ax = clock.tiltAccel(pitch);
+    const BallScalar ay = clock.tiltAccel(roll);
+    const BallScalar friction = clock.friction();
+
+    // one pass over plain arrays, no calls and no branches
+    const int n = count();
+    BallScalar* px = x.data();
+    BallScalar* py = y.data();
+    BallScalar* pvx = vx.data();
+    BallScalar* pvy = vy.data();
+    BallScalar* pdx = dx.data();
+    BallScalar* pdy = dy.data();
+    BallScalar* ppx = prev_x.data();
+    BallScalar* ppy = prev_y.data();
+    for (int i = 0; i < n; ++i) {
+        ppx[i] = px[i];
+        ppy[i] = py[i];
+        pvx[i] = (pvx[i] + ax) * friction;
+        pvy[i] = (pvy[i] + ay) * friction;
+        pdx[i] = clock.stepDelta(pvx[i]);
+        pdy[i] = clock.stepDelta(pvy[i]);
+    }
+}
+
+
+void BallSwarm::collideBalls() {
+    const int n = count();
+
+    // insertion sort by x, the order from the last step is nearly right
+    for (int i = 1; i < n; ++i) {
+        const uint8_t k = by_x[i];
+        int j = i - 1;
+        while (j >= 0 && x[by_x[j]] > x[k]) {
+            by_x[j + 1] = by_x[j];
+            --j;
+        }
+        by_x[j + 1] = k;
+    }
+
+    // sweep: a ball can only touch the ones after it that start within a diameter along x
+    const BallScalar reach = radius + radius;
+    for (int i = 0; i < n; ++i) {
+        const int a = by_x[i];
+        for (int j = i + 1; j < n; ++j) {
+            const int b = by_x[j];
+            if (x[b] - x[a] >= reach) break;
+            if (scalarAbs(y[b] - y[a]) >= reach) continue;
+            ++pair_tests;
+            resolveContact(a, b);
+        }
+    }
+}
+
+
+void BallSwarm::resolveContact(int a, int b) {
+    typedef BallScalar S;
+    const S ex = x[b] - x[a], ey = y[b] - y[a];
+    const S reach = radius + radius;
+    const S d2 = ex*ex + ey*ey;
+    if (d2 >= reach*reach) return;
+    ++contact_count;
+
+    const S d = scalarSqrt(d2);
+    S nx, ny;
+    if (d > S(1e-3f)) {
+        scalarUnit(ex, ey, d, nx, ny);
+    } else {
+        // right on top of each other, split them along x
+        nx = S(1.0f);
+        ny = S(0.0f);
+    }
+
+    // Each ball gives way by half the overlap. It goes into the step's move rather than the
+    // position, so the maze's collision pass keeps a pushed ball out of the walls.
+    const S push = (reach - d) * S(0.5f);
+    dx[a] -= nx * push;
+    dy[a] -= ny * push;
+    dx[b] += nx * push;
+    dy[b] += ny * push;
+
+    // equal masses: the normal velocities are exchanged, less what the bounce loses
+    const S vn = (vx[b] - vx[a]) * nx + (vy[b] - vy[a]) * ny;
+    if (vn >= S(0.0f)) return; // already moving apart
+    const S impulse = S(-(1.0f + RESTITUTION) * 0.5f) * vn;
+    vx[a] -= impulse * nx;
+    vy[a] -= impulse * ny;
+    vx[b] += impulse * nx;
+    vy[b] += impulse * ny;
+}
+
+
+void BallSwarm::draw() {
+    const BallScalar alpha = clock.alpha();
+    const lv_coord_t size = (lv_coord_t)(int)(radius * BallScalar(2));
+    const int n = count();
+
+    // somewhere between the last two steps, like Ball::draw
+    auto areaOf = [&](int i) {
+        lv_area_t area;
+        area.x1 = (lv_coord_t)(int)(prev_x[i] + (x[i] - prev_x[i]) * alpha - radius);
+        area.y1 = (lv_coord_t)(int)(prev_y[i] + (y[i] - prev_y[i]) * alpha - radius);
+        area.x2 = area.x1 + size - 1;
+        area.y2 = area.y1 + size - 1;
+        return area;
+    };
+    auto moved = [&](int i, const lv_area_t& area) {
+        return drawn[i].x2 < drawn[i].x1 || area.x1 != drawn[i].x1 || area.y1 != drawn[i].y1;
+    };
+
+    int moving = 0;
+    for (int i = 0; i < n; ++i) {
+        if (moved(i, areaOf(i))) ++moving;
+    }
+    if (moving == 0) return;
+
+    // Past MAX_DIRTY_AREAS LVGL would give up and redraw the whole screen, one box around
+    // everything that moved is usually a lot less
+    const bool one_box = moving > MAX_DIRTY_AREAS;
+    lv_area_t box = {LV_COORD_MAX, LV_COORD_MAX, LV_COORD_MIN, LV_COORD_MIN};
+    for (int i = 0; i < n; ++i) {
+        const lv_area_t area = areaOf(i);
+        if (!moved(i, area)) continue;
+        const lv_area_t old = drawn[i];
+        drawn[i] = area;
+
+        if (old.x2 < old.x1) {
+            if (one_box) _lv_area_join(&box, &box, &area);
+            else invalidate(area);
+            continue;
+        }
+        lv_area_t joined;
+        _lv_area_join(&joined, &old, &area);
+        if (one_box) {
+            _lv_area_join(&box, &box, &joined);
+        } else if ((uint32_t)lv_area_get_width(&joined) * lv_area_get_height(&joined) <= 2 * (uint32_t)size * size) {
+            invalidate(joined);
+        } else {
+            invalidate(old);
+            invalidate(area);
+        }
+    }
+    if (one_box) invalidate(box);
+}
+
+
+void BallSwarm::invalidate(const lv_area_t& area) {
+    if (!obj || area.x2 < area.x1) return;
+    lv_obj_invalidate_area(obj, &area);
+    invalidated_px += (uint32_t)lv_area_get_width(&area) * lv_area_get_height(&area);
+}
+
+
+void BallSwarm::drawEvent(lv_event_t* e) {
+    BallSwarm* swarm = (BallSwarm*)lv_event_get_user_data(e);
+    lv_draw_ctx_t* draw_ctx = lv_event_get_draw_ctx(e);
+
+    lv_draw_rect_dsc_t dsc;
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.bg_color = lv_palette_main(LV_PALETTE_GREEN);
+    dsc.bg_opa = LV_OPA_COVER;
+    dsc.radius = LV_RADIUS_CIRCLE;
+    dsc.border_width = 0;
+
+    lv_area_t clipped;
+    for (const lv_area_t& a : swarm->drawn) {
+        if (!_lv_area_intersect(&clipped, &a, draw_ctx->clip_area)) continue;
+        lv_draw_rect(draw_ctx, &dsc, &a);
+    }
+}
+
+
+void BallSwarm::deleteEvent(lv_event_t* e) {
+    BallSwarm* swarm = (BallSwarm*)lv_event_get_user_data(e);
+    swarm->obj = nullptr;
+}
@@ -0,0 +1,170 @@
+#ifndef BALL_SWARM_H
+#define BALL_SWARM_H
+
+#include <lvgl.h>
+#include <vector>
+#include "Ball.h"
+
+/**
+ * @class BallSwarm
+ * @brief Any number of equally sized balls in one structure of arrays.
+ *
+ * Position, velocity and the move of the current step are separate arrays, so a physics step
+ * is one plain loop over all balls (vectorized where the target has SIMD), the maze then runs
+ * its collision kernel inlined over all of them (Maze::stepSwarmWithCollisions) and
+ * collideBalls() resolves contacts between balls. A sort and sweep along x finds the pairs:
+ * the order barely changes from one step to the next, so the insertion sort is close to one
+ * pass. All balls are drawn by a single post draw callback on the parent, straight from the
+ * arrays, with the same dirty rectangles as Ball.
+ */
+class BallSwarm {
+public:
+    // Normal speed kept when two balls bounce, livelier than the 0.25 off a wall
+    static constexpr float RESTITUTION = 0.5f;
+    // More moving balls than this are invalidated as one bounding box, LVGL keeps 32 areas
+    static constexpr int MAX_DIRTY_AREAS = 16;
+
+    /**
+     * @param parent LVGL object the balls are drawn on
+     * @param capacity most balls add() accepts, all memory is taken here
+     * @param radius radius of every ball
+     */
+    BallSwarm(lv_obj_t* parent, int capacity, float radius);
+    ~BallSwarm();
+
+    // the parent's draw callback holds a pointer back to the swarm
+    BallSwarm(const BallSwarm&) = delete;
+    BallSwarm& operator=(const BallSwarm&) = delete;
+
+    /**
+     * @brief Adds a ball at rest
+     * @return its index, -1 if the swarm is full
+     */
+    int add(float x, float y);
+    int count() const { return (int)x.size(); }
+
+    void setPhysicsRate(uint16_t hz) { clock.setRate(hz); }
+    uint16_t getPhysicsRate() const { return clock.rate(); }
+
+    /**
+     * @brief Same as Ball::advanceClock, one clock for all balls
+     */
+    int advanceClock(uint32_t now_us) { return clock.advance(now_us); }
+    void restartClock(uint32_t now_us) { clock.restart(now_us); }
+
+    /**
+     * @brief One fixed step for every ball: tilt and friction on the velocity, the step's move
+     * into the delta arrays for the maze's collision pass
+     */
+    void updatePhysics(float roll, float pitch);
+
+    /**
+     * @brief Pushes overlapping balls apart and bounces them off each other
+     */
+    void collideBalls();
+
+    /**
+     * @brief Updates the balls on screen, interpolated between the last two steps
+     */
+    void draw();
+
+    float getX(int i) const { return toFloat(x[i]); }
+    float getY(int i) const { return toFloat(y[i]); }
+    float getRadius() const { return toFloat(radius); }
+
+    // Counters since the last resetStats()
+    uint32_t pairTests() const { return pair_tests; }    ///< pairs the sweep had to look at closely
+    uint32_t contacts() const { return contact_count; }  ///< pairs that actually touched
+    uint32_t invalidatedPixels() const { return invalidated_px; }
+    void resetStats() { pair_tests = contact_count = invalidated_px = 0; }
+
+    /**
+     * @class Body
+     * @brief One ball of the swarm with the interface of Ball the collision kernels use
+     */
+    class Body {
+    public:
+        Body(BallSwarm& swarm, int i) : s(swarm), i(i) {}
+
+        bool consumeDelta(BallScalar& dx, BallScalar& dy) {
+            dx = s.dx[i];
+            dy = s.dy[i];
+            // only the first call moves, like Ball
+            s.dx[i] = s.dy[i] = BallScalar(0.0f);
+            return dx != BallScalar(0.0f) || dy != BallScalar(0.0f);
+        }
+        void translate(BallScalar dx, BallScalar dy) { s.x[i] += dx; s.y[i] += dy; }
+#if MAZE_FIXED_POINT
+        bool consumeDelta(float& dx, float& dy) {
+            BallScalar qx, qy;
+            const bool moved = consumeDelta(qx, qy);
+            dx = (float)qx;
+            dy = (float)qy;
+            return moved;
+        }
+        void translate(float dx, float dy) { translate(BallScalar(dx), BallScalar(dy)); }
+#endif
+
+        float getX() const { return toFloat(s.x[i]); }
+        float getY() const { return toFloat(s.y[i]); }
+        void setX(float nx) { s.x[i] = BallScalar(nx); }
+        void setY(float ny) { s.y[i] = BallScalar(ny); }
+        float getVelocityX() const { return toFloat(s.vx[i]); }
+        float getVelocityY() const { return toFloat(s.vy[i]); }
+        void setVelocityX(float v) { s.vx[i] = BallScalar(v); }
+        void setVelocityY(float v) { s.vy[i] = BallScalar(v); }
+        float getRadius() const { return toFloat(s.radius); }
+
+        BallScalar posX() const { return s.x[i]; }
+        BallScalar posY() const { return s.y[i]; }
+        void setPosX(BallScalar v) { s.x[i] = v; }
+        void setPosY(BallScalar v) { s.y[i] = v; }
+        BallScalar velX() const { return s.vx[i]; }
+        BallScalar velY() const { return s.vy[i]; }
+        void setVelX(BallScalar v) { s.vx[i] = v; }
+        void setVelY(BallScalar v) { s.vy[i] = v; }
+        BallScalar rad() const { return s.radius; }
+
+    private:
+        BallSwarm& s;
+        int i;
+    };
+
+    Body body(int i) { return Body(*this, i); }
+
+    /**
+     * @brief Calls step(body) for every ball, the maze's collision pass goes through here
+     */
+    template <typename Step>
+    void forEachBody(Step step) {
+        const int n = count();
+        for (int i = 0; i < n; ++i) {
+            Body b(*this, i);
+            step(b);
+        }
+    }
+
+private:
+    lv_obj_t* obj = nullptr;
+    int capacity;
+    BallScalar radius;
+    PhysicsClock clock;
+
+    std::vector<BallScalar> x, y;
+    std::vector<BallScalar> vx, vy;
+    std::vector<BallScalar> dx, dy;          ///< move of the current step, until the maze consumes it
+    std::vector<BallScalar> prev_x, prev_y;  ///< positions before the last step, for interpolation
+    std::vector<uint8_t> by_x;               ///< ball indices sorted by x - radius, kept between steps
+    std::vector<lv_area_t> drawn;            ///< pixels each ball covers on screen right now
+
+    uint32_t pair_tests = 0;
+    uint32_t contact_count = 0;
+    uint32_t invalidated_px = 0;
+
+    void resolveContact(int a, int b);
+    void invalidate(const lv_area_t& area);
+    static void drawEvent(lv_event_t* e);
+    static void deleteEvent(lv_event_t* e);
+};
+
+#endif // BALL_SWARM_H
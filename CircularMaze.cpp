@@ -3,305 +3,290 @@
 #include <math.h>
 #include <vector>
 
+CircularMaze::CircularMaze(int rings, int sectors, int spacing, bool adaptive)
+    : CircularMaze(rings, sectors, spacing, adaptive, nullptr) {}
 
-CircularMaze::CircularMaze(int rings, int sectors, int spacing) {
+CircularMaze::CircularMaze(int rings, int sectors, int spacing, bool adaptive, uint8_t* wall_storage) {
     NUM_RINGS = rings;
     SECTORS_PER_RING = sectors;
     RING_SPACING = spacing;
-    wall_buffer_idx = 0;
-    // Resize the 2D vectors to match the new dimensions
-    radial_walls.resize(NUM_RINGS, std::vector<bool>(SECTORS_PER_RING));
-    circular_walls.resize(NUM_RINGS, std::vector<bool>(SECTORS_PER_RING));
-    visited_circular.resize(NUM_RINGS, std::vector<bool>(SECTORS_PER_RING));
-
-    // Resize the LVGL point buffer
-    int max_walls = (NUM_RINGS * SECTORS_PER_RING) * 2 + 1;
-    point_buffer.resize(max_walls);
+    ADAPTIVE = adaptive;
+
+    // Ring layout and directions, shared with any other maze of the same layout
+    table = PolarTable::acquire(NUM_RINGS, SECTORS_PER_RING, ADAPTIVE);
+    ring_start = table->ringStartTable();
+    ring_sectors = table->ringSectorsTable();
+    geometry = PolarGeometry(table, RING_SPACING);
+
+    // One flat allocation for all walls, unless the caller brought its own
+    if (!wall_storage) {
+        owned_walls.resize(ring_start[NUM_RINGS]);
+        wall_storage = owned_walls.data();
+    }
+    cell_walls = wall_storage;
+
+    // Size the wall layer, one spoke and one arc per cell plus the extra arc halves
+    int max_walls = ring_start[NUM_RINGS] * 2 + table->splitArcs() + 1;
+    wall_layer.reserve(max_walls, max_walls * (POINTS_PER_ARC + 1));
+
+    analyzer.reserve(cellCount());
 }
 
-void CircularMaze::generate() {
-    for (int r = 0; r < NUM_RINGS; r++) {
-        for (int s = 0; s < SECTORS_PER_RING; s++) {
-            radial_walls[r][s] = true;
-            circular_walls[r][s] = true;
-            visited_circular[r][s] = false;
-        }
-    }
-    // Set the centermost area of the maze as already visited so the inner area is fully carved out
-    for (int s = 0; s < SECTORS_PER_RING; ++s) {
-        visited_circular[0][s] = true; 
-    }
+CircularMaze::~CircularMaze() {
+    PolarTable::release(table);
+}
+
+void CircularMaze::beginGenerate() {
+    rng.setSeed(seed);
+
+    // All walls up in every cell, memset resets the table a word at a time
+    uint8_t all = ARC_IN | ARC_OUT | SPOKE_CCW | SPOKE_CW | (ADAPTIVE ? ARC_OUT_B : 0);
+    memset(cell_walls, all, ring_start[NUM_RINGS]);
 
     // Create an exit on the outer perimeter
     placeExitAndSpawn();
 
-    carve(NUM_RINGS - 1, exit_sector);
+    // The hub is not part of the grid so the inner area stays fully carved out
+    generator.begin(*this, exitCell(), rng);
+}
 
+MazeId CircularMaze::getId() const {
+    MazeId id;
+    id.type = MazeType::Circular;
+    id.algorithm = getAlgorithm();
+    id.dims[0] = NUM_RINGS;
+    id.dims[1] = SECTORS_PER_RING;
+    id.dims[2] = RING_SPACING;
+    id.dims[3] = ADAPTIVE ? 1 : 0;
+    id.seed = seed;
+    id.exit_placement = exit_placement;
+    return id;
+}
+
+void CircularMaze::finishGenerate() {
+    wall_index_stale = true;
+
+    // grid cells of the outer ring start here (hub is not part of the grid)
+    const int outer = ring_start[NUM_RINGS - 1] - ring_start[1];
+    analyzer.run(*this, outer + spawn_sector, outer + exit_sector);
+    if (exit_placement != ExitPlacement::Farthest) return;
+
+    int best = exit_sector;
+    uint16_t best_d = 0;
+    for (int s = 0; s < ring_sectors[NUM_RINGS - 1]; ++s) {
+        uint16_t d = analyzer.distance(outer + s);
+        if (d != MazeAnalyzer::UNREACHED && d > best_d) { best_d = d; best = s; }
+    }
+    setExitSector(best);
+    analyzer.setTarget(outer + best);
 }
 
 void CircularMaze::placeExitAndSpawn() {
+    const int outer_sectors = ring_sectors[NUM_RINGS - 1];
+
     // EXIT on outer perimeter at a random sector (no wall removal)
-    exit_sector = random(0, SECTORS_PER_RING);
+    setExitSector(rng.below(outer_sectors));
 
-    const float step = 2.0f * M_PI / SECTORS_PER_RING;
-    float exit_angle_mid = (exit_sector + 0.5f) * step;      // center of sector
     float exit_radius    = (NUM_RINGS - 0.5) * RING_SPACING;         // perimeter radius
 
-    exit_px = {
-        (lv_coord_t)(CENTER_X + cosf(exit_angle_mid) * exit_radius),
-        (lv_coord_t)(CENTER_Y + sinf(exit_angle_mid) * exit_radius)
-    };
-
     // SPAWN at diametrically opposite angle, at a safe "between-arcs" radius
-    int opposite_sector = (exit_sector + SECTORS_PER_RING / 2) % SECTORS_PER_RING;
-    float spawn_angle   = (opposite_sector) * step;
+    int opposite_sector = (exit_sector + outer_sectors / 2) % outer_sectors;
+    spawn_ring = NUM_RINGS - 1;
+    spawn_sector = opposite_sector;
 
-    ball_spawn_px = {
-        (lv_coord_t)(CENTER_X + cosf(spawn_angle) * exit_radius),
-        (lv_coord_t)(CENTER_Y + sinf(spawn_angle) * exit_radius)
-    };
+    ball_spawn_px = polarPixel(table->boundary(spawn_ring, opposite_sector), exit_radius);
 }
 
-void CircularMaze::draw(lv_obj_t* parent, bool animate) {
-    wall_buffer_idx = 0; // Reset buffer index each time we redraw
-
-    // LVGL One-time style init for wall lines
-    static lv_style_t style_wall_circular;
-    lv_style_init(&style_wall_circular);
-    lv_style_set_line_width(&style_wall_circular, 2);
-    lv_style_set_line_color(&style_wall_circular, lv_color_white());
-    lv_style_set_line_rounded(&style_wall_circular, true);
-
-    const float angle_step = 2 * M_PI / SECTORS_PER_RING;
-
-    // Draw Radial Walls (Spokes) — one spoke segment per annulus
-    for (int ring = 2; ring < NUM_RINGS; ++ring) {
-        float r1 = ring * RING_SPACING;           // inner arc of this annulus
-        float r2 = (ring + 1) * RING_SPACING;     // outer arc of this annulus
-        for (int s = 0; s < SECTORS_PER_RING; ++s) {
-            if (!radial_walls[ring - 1][s]) continue;  // <-- annulus stored at ring-1!
-            float angle = s * angle_step;
-
-            if (wall_buffer_idx < point_buffer.size()) {
-                point_buffer[wall_buffer_idx][0] = {
-                    (lv_coord_t)(CENTER_X + cosf(angle) * r1),
-                    (lv_coord_t)(CENTER_Y + sinf(angle) * r1)
-                };
-                point_buffer[wall_buffer_idx][1] = {
-                    (lv_coord_t)(CENTER_X + cosf(angle) * r2),
-                    (lv_coord_t)(CENTER_Y + sinf(angle) * r2)
-                };
-                lv_obj_t *wall = lv_line_create(parent);
-                lv_line_set_points(wall, point_buffer[wall_buffer_idx].data(), 2);
-                lv_obj_add_style(wall, &style_wall_circular, 0);
-                wall_buffer_idx++;
-                if (animate) lv_timer_handler();
-            }
-        }
-    }
-    
-    // Draw Circular Walls (Arcs)
-    for (int r = 1; r < NUM_RINGS; r++) { // no need to draw the first ring since theere are no walls there
-        for (int s = 0; s < SECTORS_PER_RING; s++) {
-            if (circular_walls[r][s]) {
-                if (wall_buffer_idx < point_buffer.size()) {
-                    float radius = (r + 1) * RING_SPACING;
-                    float start_angle = s * angle_step;
-                    
-                    for(int i = 0; i <= POINTS_PER_ARC; i++) {
-                        float current_angle = start_angle + (float)i * (angle_step / POINTS_PER_ARC);
-                        point_buffer[wall_buffer_idx][i].x = (lv_coord_t)(CENTER_X + cos(current_angle) * radius);
-                        point_buffer[wall_buffer_idx][i].y = (lv_coord_t)(CENTER_Y + sin(current_angle) * radius);
-                    }
-
-                    lv_obj_t *arc_wall = lv_line_create(parent);
-                    lv_line_set_points(arc_wall, point_buffer[wall_buffer_idx].data(), POINTS_PER_ARC + 1);
-                    lv_obj_add_style(arc_wall, &style_wall_circular, 0);
-                    wall_buffer_idx++;
-
-                    if (animate) lv_timer_handler();
+void CircularMaze::setExitSector(int s) {
+    exit_sector = s;
+
+    float exit_radius    = (NUM_RINGS - 0.5) * RING_SPACING;         // perimeter radius
+
+    // center of sector
+    exit_px = polarPixel(table->middle(NUM_RINGS - 1, exit_sector), exit_radius);
+}
+
+int CircularMaze::cellAtPixel(float x, float y) const {
+    float dx = x - CENTER_X;
+    float dy = y - CENTER_Y;
+    int ring = (int)(sqrtf(dx*dx + dy*dy) / RING_SPACING);
+    if (ring >= NUM_RINGS) return -1;
+    if (ring < 1) ring = 1;
+
+    return ring_start[ring] - ring_start[1] + table->sectorOf(ring, dx, dy);
+}
+
+lv_point_t CircularMaze::cellCenterPixel(int cell) const {
+    int ring = ringOf(cell + ring_start[1]);
+    int sector = cell + ring_start[1] - ring_start[ring];
+    return polarPixel(table->middle(ring, sector), (ring + 0.5f) * RING_SPACING);
+}
+
+void CircularMaze::beginDraw(lv_obj_t* parent) {
+    draw_parent = parent;
+    draw_cursor = 0;
+    wall_layer.begin(parent);
+}
+
+bool CircularMaze::drawStep(uint32_t max_walls) {
+    // Spokes of rings 2..NUM_RINGS-1 first, then the outer arcs of rings 1..NUM_RINGS-1.
+    // Both are walked one cell (mask index) per slot.
+    const int spoke_slots = ring_start[NUM_RINGS] - ring_start[2];
+    const int total_slots = spoke_slots + ring_start[NUM_RINGS] - ring_start[1];
+
+    while (draw_cursor < total_slots && max_walls > 0) {
+        int k = draw_cursor++;
+        if (k < spoke_slots) {
+            // Draw Radial Walls (Spokes) — one spoke segment per annulus
+            int m = ring_start[2] + k;
+            if (!(cell_walls[m] & SPOKE_CCW)) continue;
+            int ring = ringOf(m);
+            addSpoke(table->boundary(ring, m - ring_start[ring]), ring * RING_SPACING, (ring + 1) * RING_SPACING);
+        } else {
+            // Draw Circular Walls (Arcs), no need to draw the first ring since theere are no walls there
+            int m = ring_start[1] + k - spoke_slots;
+            int r = ringOf(m), s = m - ring_start[r];
+            uint8_t w = cell_walls[m];
+            if (!geometry.splitsOut(r)) {
+                if (!(w & ARC_OUT)) continue;
+                addArc(r, s);
+            } else {
+                // the ring outside has twice the sectors, each half of the arc is its own wall
+                // and matches one sector of that ring
+                if (!(w & (ARC_OUT | ARC_OUT_B))) continue;
+                if ((w & ARC_OUT) && (w & ARC_OUT_B)) {
+                    addArc(r, s);
+                } else if (w & ARC_OUT) {
+                    addArc((r + 1) * RING_SPACING, r + 1, 2 * s);
+                } else {
+                    addArc((r + 1) * RING_SPACING, r + 1, 2 * s + 1);
                 }
             }
         }
+        --max_walls;
+    }
+    wall_layer.flush();
+    if (draw_cursor < total_slots) return false;
+
+    if (draw_cursor == total_slots) {
+        // Draw exit
+        lv_obj_t* exitObj = lv_obj_create(draw_parent);
+        int dot = max(2, RING_SPACING - 2);
+        lv_obj_set_size(exitObj, dot, dot);
+        lv_obj_set_pos(exitObj, exit_px.x - dot/2, exit_px.y - dot/2);
+        lv_obj_set_style_bg_color(exitObj, lv_color_make(255, 0, 0), 0);
+        lv_obj_set_style_border_width(exitObj, 0, 0);
+        lv_obj_set_style_radius(exitObj, 0, 0);  // square, not circle
+        draw_cursor++;
     }
+    return true;
+}
 
-    // Draw exit
-    lv_obj_t* exitObj = lv_obj_create(parent);
-    int dot = max(2, RING_SPACING - 2);
-    lv_obj_set_size(exitObj, dot, dot);
-    lv_obj_set_pos(exitObj, exit_px.x - dot/2, exit_px.y - dot/2);
-    lv_obj_set_style_bg_color(exitObj, lv_color_make(255, 0, 0), 0);
-    lv_obj_set_style_border_width(exitObj, 0, 0);
-    lv_obj_set_style_radius(exitObj, 0, 0);  // square, not circle
-
-    // Final actual draw to screen
-    lv_timer_handler();
+void CircularMaze::addSpoke(const PolarDir& dir, float r1, float r2) {
+    wall_layer.addLine(polarPixel(dir, r1), polarPixel(dir, r2));
 }
 
-// Very similar to the rectangular maze carve
-void CircularMaze::carve(int ring, int sector) {
-    visited_circular[ring][sector] = true;
-
-    // Fisher-Yates shuffle 1-liner
-    int dirs[4] = {0,1,2,3}; // 0=Out, 1=In, 2=CW, 3=CCW
-    for (int i = 3; i > 0; --i) { int j = random(i+1); int t = dirs[i]; dirs[i]=dirs[j]; dirs[j]=t; }
-
-    for (int k = 0; k < 4; ++k) {
-        int dir = dirs[k];
-        int nr = ring, ns = sector;
-
-        if (dir == 0) nr = ring + 1;                           // Out
-        else if (dir == 1) nr = ring - 1;                      // In
-        else if (dir == 2) ns = (sector + 1) % SECTORS_PER_RING;   // CW
-        else               ns = (sector - 1 + SECTORS_PER_RING) % SECTORS_PER_RING; // CCW
-
-        // Playable rings are 1..NUM_RINGS-1 (exclude the hub at 0)
-        if (nr < 1 || nr >= NUM_RINGS) continue;
-        if (visited_circular[nr][ns]) continue;
-
-        // Knock down the wall BETWEEN (ring,sector) and (nr,ns)
-        if (dir == 0) {                                  // Out -> clear outer arc at (ring+1)*spacing
-            circular_walls[ring][sector] = false;
-        } else if (dir == 1) {                           // In -> clear inner arc at ring*spacing
-            circular_walls[ring - 1][sector] = false;
-        } else if (dir == 2) {                           // CW -> clear spoke at (sector+1)*step across THIS annulus
-            radial_walls[ring - 1][(sector + 1) % SECTORS_PER_RING] = false;
-        } else {                                         // CCW -> clear spoke at sector*step across THIS annulus
-            radial_walls[ring - 1][sector] = false;
-        }
+void CircularMaze::addArc(float radius, int ring, int sector) {
+    lv_point_t pts[POINTS_PER_ARC + 1];
+    for(int i = 0; i <= POINTS_PER_ARC; i++) {
+        pts[i] = polarPixel(table->arcPoint(ring, sector * POINTS_PER_ARC + i), radius);
+    }
+    wall_layer.addPolyline(pts, POINTS_PER_ARC + 1);
+}
 
-        carve(nr, ns);
+int CircularMaze::neighbors(int cell, int* out) const {
+    const int m = cell + ring_start[1];
+    const int ring = ringOf(m);
+    const int sector = m - ring_start[ring];
+    const int n_ring = ring_sectors[ring];
+    const int first = cell - sector; // grid index of sector 0 in this ring
+    int n = 0;
+    // Playable rings are 1..NUM_RINGS-1 (exclude the hub at 0)
+    if (ring < NUM_RINGS - 1) {                                              // Out
+        const int out_first = ring_start[ring + 1] - ring_start[1];
+        if (ring_sectors[ring + 1] == n_ring) {
+            out[n++] = out_first + sector;
+        } else {
+            out[n++] = out_first + 2 * sector;
+            out[n++] = out_first + 2 * sector + 1;
+        }
+    }
+    if (ring > 1) {                                                          // In
+        const int in_first = ring_start[ring - 1] - ring_start[1];
+        out[n++] = in_first + (ring_sectors[ring - 1] == n_ring ? sector : sector / 2);
     }
+    out[n++] = first + (sector + 1) % n_ring;                                // CW
+    out[n++] = first + (sector - 1 + n_ring) % n_ring;                       // CCW
+    return n;
 }
 
 
-// Note:
-// Arc normals are radial thus reflect radial component; spoke normals are tangential thus reflect tangential component.
-void CircularMaze::handleCollisions(Ball &ball) {
-    float cx = ball.getX();
-    float cy = ball.getY();
-    const float br = ball.getRadius();
-
-    // polar coords from ball x and y 
-    float dx = cx - CENTER_X;
-    float dy = cy - CENTER_Y;
-    float r  = sqrtf(dx*dx + dy*dy); // distance from maze center to ball center
-    if (r <= 1e-6f) return;
-
-    float a = atan2f(dy, dx); // angle in radians
-    if (a < 0) a += 2.0f * M_PI; // shifted to [0,  2*Pi]
-
-    //computer current ring and sector ball is currently in
-    const float step = (2.0f * M_PI) / SECTORS_PER_RING;
-    int ring = (int)floorf(r / RING_SPACING);          // polar "ring" index (0..)
-    if (ring < 0) ring = 0;
-    if (ring > NUM_RINGS - 1) ring = NUM_RINGS - 1;
-
-    int sector = (int)floorf(a / step); // sector ball is in
-    if (sector < 0) sector = 0;
-    if (sector > SECTORS_PER_RING - 1) sector = SECTORS_PER_RING - 1;
-
-    // basis (FLOATS, not lv_point_t)
-    float urx = cosf(a),  ury = sinf(a);               // radial unit
-    float utx = -sinf(a), uty = cosf(a);               // tangential unit
-
-    auto dot = [](float x1,float y1,float x2,float y2){ return x1*x2 + y1*y2; };
-
-    bool collided = false;
-    float vx = ball.getVelocityX();
-    float vy = ball.getVelocityY();
-
-    // ---------- ARCS ----------
-    // INNER arc of annulus 'ring' lives at circular_walls[ring-1][*] at radius = ring*spacing
-    if (ring > 1 && circular_walls[ring - 1][sector]) {
-        float arcR = ring * RING_SPACING;
-        float pen  = (arcR + br) - r;   // >0 if ball center is too far inward
-        // if arc is penetrated
-        if (pen > 0.0f) {
-            float new_r = arcR + br; // move ball outward from arc
-            cx = CENTER_X + new_r * urx;
-            cy = CENTER_Y + new_r * ury;
-
-            float v_r = dot(vx, vy, urx, ury); // radial speed
-            float v_t = dot(vx, vy, utx, uty); // tangential speed
-            v_r = -0.25f * v_r;           // damped reflection
-            vx  = v_r*urx + v_t*utx;      // calculate new radially dampened velocity 
-            vy  = v_r*ury + v_t*uty;
-
-            //r = new_r;
-            collided = true;
+int CircularMaze::openNeighbors(int cell, int* out) const {
+    const int m = cell + ring_start[1];
+    const int ring = ringOf(m);
+    const int sector = m - ring_start[ring];
+    const int n_ring = ring_sectors[ring];
+    const int first = cell - sector;
+    const uint8_t w = cell_walls[m];
+    int n = 0;
+    // ring 1 keeps its inner arc and the outer ring its outer arc, so only the sector wraps
+    if (ring < NUM_RINGS - 1) {
+        const int out_first = ring_start[ring + 1] - ring_start[1];
+        if (ring_sectors[ring + 1] == n_ring) {
+            if (!(w & ARC_OUT)) out[n++] = out_first + sector;
+        } else {
+            if (!(w & ARC_OUT))   out[n++] = out_first + 2 * sector;
+            if (!(w & ARC_OUT_B)) out[n++] = out_first + 2 * sector + 1;
         }
     }
+    if (!(w & ARC_IN) && ring > 1) {
+        const int in_first = ring_start[ring - 1] - ring_start[1];
+        out[n++] = in_first + (ring_sectors[ring - 1] == n_ring ? sector : sector / 2);
+    }
+    if (!(w & SPOKE_CW))  out[n++] = first + (sector + 1) % n_ring;
+    if (!(w & SPOKE_CCW)) out[n++] = first + (sector - 1 + n_ring) % n_ring;
+    return n;
+}
 
-  // OUTER arc of annulus 'ring' lives at circular_walls[ring][*] at radius = (ring+1)*spacing
-  if (ring > 0 && ring < NUM_RINGS && circular_walls[ring][sector]) {
-    float arcR = (ring + 1) * RING_SPACING;
-    float pen  = r + br - arcR;     // >0 if ball center too far outward
-    if (pen > 0.0f) {
-      float new_r = arcR - br;
-      cx = CENTER_X + new_r * urx;
-      cy = CENTER_Y + new_r * ury;
-
-      float v_r = dot(vx, vy, urx, ury);
-      float v_t = dot(vx, vy, utx, uty);
-      v_r = -0.25f * v_r;
-      vx  = v_r*urx + v_t*utx;
-      vy  = v_r*ury + v_t*uty;
-
-      //r = new_r;
-      collided = true;
+
+int CircularMaze::northOf(int cell) const {
+    const int m = cell + ring_start[1];
+    const int ring = ringOf(m);
+    if (ring <= 1) return -1;
+    const int sector = m - ring_start[ring];
+    const int in_first = ring_start[ring - 1] - ring_start[1];
+    return in_first + (ring_sectors[ring - 1] == ring_sectors[ring] ? sector : sector / 2);
+}
+
+
+void CircularMaze::link(int a, int b) {
+    // grid cells skip the hub ring, wall masks do not
+    const int ma = a + ring_start[1], mb = b + ring_start[1];
+    int ring = ringOf(ma), sector = ma - ring_start[ring];
+    int nr = ringOf(mb),   ns = mb - ring_start[nr];
+    uint8_t& wa = cell_walls[ma];
+    uint8_t& wb = cell_walls[mb];
+
+    // Knock down the wall BETWEEN (ring,sector) and (nr,ns).
+    // Across a doubling the outer cell with the odd sector sits behind the second arc half.
+    if (nr == ring + 1) {                                    // Out -> clear outer arc at (ring+1)*spacing
+        bool half_b = ring_sectors[nr] != ring_sectors[ring] && (ns & 1);
+        wa &= half_b ? ~ARC_OUT_B : ~ARC_OUT; wb &= ~ARC_IN;
+    } else if (nr == ring - 1) {                             // In -> clear inner arc at ring*spacing
+        bool half_b = ring_sectors[ring] != ring_sectors[nr] && (sector & 1);
+        wa &= ~ARC_IN;  wb &= half_b ? ~ARC_OUT_B : ~ARC_OUT;
+    } else if (ns == (sector + 1) % ring_sectors[ring]) {    // CW -> clear spoke at (sector+1)*step across THIS annulus
+        wa &= ~SPOKE_CW; wb &= ~SPOKE_CCW;
+    } else {                                                 // CCW -> clear spoke at sector*step across THIS annulus
+        wa &= ~SPOKE_CCW; wb &= ~SPOKE_CW;
     }
-  }
-
-  // ---------- SPOKES ----------
-  // spokes across THIS annulus exist only for ring >= 2 and live in radial_walls[ring-1][*]
-  if (ring > 1) {
-    float rInner = ring * RING_SPACING;
-    float rOuter = (ring + 1) * RING_SPACING;
-
-    auto resolveSpoke = [&](int spokeS) {
-      if (!radial_walls[ring - 1][spokeS]) return;
-      float spokeA = spokeS * step; // spkoe angle
-      float dA = a - spokeA; 
-      // perpendicular distance to the spoke line through origin
-      float perp = fabsf(r * sinf(dA));
-      bool insideSpan = (r >= rInner - br) && (r <= rOuter + br);
-      if (!insideSpan) return;
-      if (perp <= br) { // if ball intersects spoke
-        // push along tangent to achieve perp == br
-        float sign = (sinf(dA) >= 0.f) ? 1.f : -1.f; // Are we hitting the CW or CCW spoke
-        float need = (br - perp);
-        cx += sign * utx * need;
-        cy += sign * uty * need;
-
-        // recompute basis
-        dx = cx - CENTER_X;
-        dy = cy - CENTER_Y;
-        r = sqrtf(dx*dx + dy*dy);
-        a  = atan2f(dy, dx);
-        if (a < 0) a += 2.0f*M_PI;
-        urx = cosf(a);  ury = sinf(a);
-        utx = -sinf(a); uty = cosf(a);
-
-        float v_r = dot(vx, vy, urx, ury);
-        float v_t = dot(vx, vy, utx, uty);
-        v_t = -0.25f * v_t;  // reflect across tangent (spoke normal)
-        vx  = v_r*urx + v_t*utx;
-        vy  = v_r*ury + v_t*uty;
-
-        collided = true;
-      }
-    };
-
-    // left boundary at angle = sector*step, right boundary at (sector+1)*step
-    resolveSpoke(sector);
-    resolveSpoke((sector + 1) % SECTORS_PER_RING);
-  }
-
-  if (collided) {
-    ball.setX(cx); ball.setY(cy);
-    ball.setVelocityX(vx); ball.setVelocityY(vy);
-  }
+}
+
+
+void CircularMaze::handleCollisions(Ball &ball) {
+    if (const WallDistanceField* field = fieldFor(collision_mode)) field->collide(ball);
+    else if (collision_mode == CollisionMode::Indexed) wallIndex().collide(ball);
+    else collidePolarCell(ball, cell_walls, geometry);
 }
 
 
@@ -309,20 +294,18 @@ void CircularMaze::handleCollisions(Ball &ball) {
 void CircularMaze::stepBallWithCollisions(Ball& ball,
                                           float max_step_px,
                                           uint8_t max_substeps) {
-    float dx, dy;
-    if (!ball.consumeDelta(dx, dy)) return; // no motion this frame
-
-    if (max_step_px <= 0.0f) max_step_px = ball.getRadius() * 0.5f;
-    float max_axis = fabsf(dx) > fabsf(dy) ? fabsf(dx) : fabsf(dy);
-    int steps = (int)ceilf(max_axis / max_step_px);
-    if (steps < 1) steps = 1;
-    if ((uint8_t)steps > max_substeps) steps = max_substeps;
+    if (const WallDistanceField* field = fieldFor(collision_mode)) stepFieldBody(ball, *field, max_step_px, max_substeps);
+    else stepPolarBody(ball, cell_walls, geometry, collision_mode, indexFor(collision_mode), max_step_px, max_substeps);
+}
 
-    float sx = dx / steps;
-    float sy = dy / steps;
 
-    for (int i = 0; i < steps; ++i) {
-        ball.translate(sx, sy);
-        handleCollisions(ball);   // resolve against arcs/spokes per sub-step
-    }
+void CircularMaze::stepSwarmWithCollisions(BallSwarm& swarm,
+                                           float max_step_px,
+                                           uint8_t max_substeps) {
+    const WallDistanceField* field = fieldFor(collision_mode);
+    const PolarWallIndex* index = indexFor(collision_mode);
+    swarm.forEachBody([&](BallSwarm::Body& b) {
+        if (field) stepFieldBody(b, *field, max_step_px, max_substeps);
+        else stepPolarBody(b, cell_walls, geometry, collision_mode, index, max_step_px, max_substeps);
+    });
 }
@@ -1,10 +1,290 @@
 #ifndef CIRCULAR_MAZE_H
 #define CIRCULAR_MAZE_H
 
-#include "Maze.h"
+#include "maze.h"
 #include <vector>
-#include <array>
 #include "Ball.h"
+#include "BallSwarm.h"
+#include "PolarTable.h"
+#include "SweptCollision.h"
+#include "PolarWallIndex.h"
+#include <math.h>
+
+/**
+ * @brief Wall bits of one polar cell, a set bit means the wall is up
+ */
+enum PolarWall : uint8_t {
+    ARC_IN    = 1 << 0, ///< arc at radius ring * RING_SPACING
+    ARC_OUT   = 1 << 1, ///< arc at radius (ring + 1) * RING_SPACING
+    SPOKE_CCW = 1 << 2, ///< spoke at angle sector * step
+    SPOKE_CW  = 1 << 3, ///< spoke at angle (sector + 1) * step
+    ARC_OUT_B = 1 << 4  ///< second half of the outer arc when the next ring has twice the sectors (ARC_OUT is the first half)
+};
+
+/**
+ * @brief Polar dimensions as read by the collision kernel, known at runtime.
+ * FixedPolarGeometry (FixedMaze.h) has the same interface with compile time values.
+ */
+struct PolarGeometry {
+    const PolarTable* table_ = nullptr;
+    int spacing_ = 1;
+    float inv_spacing_ = 1.0f;
+    BallScalar ball_inv_spacing_ = BallScalar(1.0f);
+
+    PolarGeometry() {}
+    PolarGeometry(const PolarTable* table, int spacing)
+        : table_(table), spacing_(spacing), inv_spacing_(1.0f / spacing), ball_inv_spacing_(1.0f / spacing) {}
+
+    int rings() const { return table_->rings(); }
+    int spacing() const { return spacing_; }
+    float invSpacing() const { return inv_spacing_; }
+    int ringSectors(int ring) const { return table_->ringSectors(ring); }
+    int ringStart(int ring) const { return table_->ringStart(ring); }
+    /// true when the ring outside has twice the sectors, the outer arc is then stored as two halves
+    bool splitsOut(int ring) const { return ring + 1 < rings() && ringSectors(ring + 1) != ringSectors(ring); }
+    int sectorOf(int ring, float dx, float dy) const { return table_->sectorOf(ring, dx, dy); }
+    const PolarDir& boundary(int ring, int s) const { return table_->boundary(ring, s); }
+    const PolarDir& middle(int ring, int s) const { return table_->middle(ring, s); }
+    // the same in the ball's format, for collidePolarCell
+    BallScalar ballInvSpacing() const { return ball_inv_spacing_; }
+    int ballSectorOf(int ring, BallScalar dx, BallScalar dy) const { return table_->ballSectorOf(ring, dx, dy); }
+    const BallDir& ballBoundary(int ring, int s) const { return table_->ballBoundary(ring, s); }
+    const BallDir& ballMiddle(int ring, int s) const { return table_->ballMiddle(ring, s); }
+    static constexpr int centerX() { return 120; }
+    static constexpr int centerY() { return 120; }
+};
+
+/**
+ * @brief Resolves the ball against the arcs and spokes of the cell it is in, shared by the runtime
+ * and the compile time sized mazes so both behave exactly the same
+ * @param cell_walls PolarWall masks, index = ringStart(ring) + sector (hub ring included)
+ * @param g PolarGeometry or FixedPolarGeometry
+ *
+ * Arc normals are radial thus reflect radial component; spoke normals are tangential thus reflect tangential component.
+ * The only non trivial math is one sqrt, sectors and spoke distances come from the table's unit vectors.
+ * Works in BallScalar throughout, so a fixed point build runs it on integers only.
+ * ball is a Ball or a BallSwarm::Body.
+ */
+template <typename Geometry, typename Body>
+inline void collidePolarCell(Body& ball, const uint8_t* cell_walls, const Geometry& g) {
+    typedef BallScalar S;
+    S cx = ball.posX();
+    S cy = ball.posY();
+    const S br = ball.rad();
+    const S center_x = S(g.centerX()), center_y = S(g.centerY());
+    const S zero = S(0.0f);
+
+    // polar coords from ball x and y 
+    S dx = cx - center_x;
+    S dy = cy - center_y;
+    S r  = scalarSqrt(dx*dx + dy*dy); // distance from maze center to ball center
+    if (r <= S(1e-6f)) return;
+
+    //computer current ring and sector ball is currently in
+    int ring = (int)(r * g.ballInvSpacing());      // polar "ring" index (0..)
+    if (ring > g.rings() - 1) ring = g.rings() - 1;
+    const int sectors = g.ringSectors(ring);
+    const int sector = g.ballSectorOf(ring, dx, dy); // sector ball is in
+
+    // basis (scalars, not lv_point_t)
+    S urx, ury;
+    scalarUnit(dx, dy, r, urx, ury);                   // radial unit
+    S utx = -ury, uty = urx;                           // tangential unit
+
+    auto dot = [](S x1,S y1,S x2,S y2){ return x1*x2 + y1*y2; };
+
+    bool collided = false;
+    S vx = ball.velX();
+    S vy = ball.velY();
+
+    // every wall around the cell in one load
+    const uint8_t walls = cell_walls[g.ringStart(ring) + sector];
+
+    // ---------- ARCS ----------
+    // INNER arc of annulus 'ring' at radius = ring*spacing
+    if (ring > 1 && (walls & ARC_IN)) {
+        S arcR = S(ring * g.spacing());
+        S pen  = (arcR + br) - r;       // >0 if ball center is too far inward
+        // if arc is penetrated
+        if (pen > zero) {
+            S new_r = arcR + br; // move ball outward from arc
+            cx = center_x + new_r * urx;
+            cy = center_y + new_r * ury;
+
+            S v_r = dot(vx, vy, urx, ury); // radial speed
+            S v_t = dot(vx, vy, utx, uty); // tangential speed
+            v_r = S(-WALL_BOUNCE) * v_r;  // damped reflection
+            vx  = v_r*urx + v_t*utx;      // calculate new radially dampened velocity 
+            vy  = v_r*ury + v_t*uty;
+
+            //r = new_r;
+            collided = true;
+        }
+    }
+
+  // OUTER arc of annulus 'ring' at radius = (ring+1)*spacing, the half under the ball if it is split
+  uint8_t out_bit = ARC_OUT;
+  if (g.splitsOut(ring)) {
+    const BallDir& m = g.ballMiddle(ring, sector);
+    if (m.x * dy - m.y * dx > zero) out_bit = ARC_OUT_B; // past the middle of the sector
+  }
+  if (ring > 0 && ring < g.rings() && (walls & out_bit)) {
+    S arcR = S((ring + 1) * g.spacing());
+    S pen  = r + br - arcR;         // >0 if ball center too far outward
+    if (pen > zero) {
+      S new_r = arcR - br;
+      cx = center_x + new_r * urx;
+      cy = center_y + new_r * ury;
+
+      S v_r = dot(vx, vy, urx, ury);
+      S v_t = dot(vx, vy, utx, uty);
+      v_r = S(-WALL_BOUNCE) * v_r;
+      vx  = v_r*urx + v_t*utx;
+      vy  = v_r*ury + v_t*uty;
+
+      //r = new_r;
+      collided = true;
+    }
+  }
+
+  // ---------- SPOKES ----------
+  // spokes across THIS annulus exist only for ring >= 2
+  if (ring > 1) {
+    S rInner = S(ring * g.spacing());
+    S rOuter = S((ring + 1) * g.spacing());
+
+    auto resolveSpoke = [&](int spokeS, uint8_t bit) {
+      if (!(walls & bit)) return;
+      const BallDir& s = g.ballBoundary(ring, spokeS); // spoke direction
+      // signed perpendicular distance to the spoke line through origin, > 0 on the counter clockwise side
+      S side = s.x * (cy - center_y) - s.y * (cx - center_x);
+      S perp = scalarAbs(side);
+      bool insideSpan = (r >= rInner - br) && (r <= rOuter + br);
+      if (!insideSpan) return;
+      if (perp <= br) { // if ball intersects spoke
+        // push along the spoke normal to achieve perp == br
+        S nx = -s.y, ny = s.x;
+        S sign = (side >= zero) ? S(1.0f) : S(-1.0f); // Are we hitting the CW or CCW spoke
+        S need = (br - perp);
+        cx += sign * nx * need;
+        cy += sign * ny * need;
+
+        S v_n = dot(vx, vy, nx, ny);
+        vx -= S(1.0f + WALL_BOUNCE) * v_n * nx;  // reflect across the spoke, keeping a quarter of the speed
+        vy -= S(1.0f + WALL_BOUNCE) * v_n * ny;
+
+        collided = true;
+      }
+    };
+
+    // left boundary at angle = sector*step, right boundary at (sector+1)*step
+    resolveSpoke(sector, SPOKE_CCW);
+    resolveSpoke((sector + 1) % sectors, SPOKE_CW);
+  }
+
+  if (collided) {
+    ball.setPosX(cx); ball.setPosY(cy);
+    ball.setVelX(vx); ball.setVelY(vy);
+  }
+}
+
+
+/**
+ * @brief Earliest contact of a ball move with the arcs and spokes it can reach
+ * @param cell_walls PolarWall masks, index = ringStart(ring) + sector (hub ring included)
+ * @param g PolarGeometry or FixedPolarGeometry
+ *
+ * Same walls as collidePolarCell sees: outer arcs of rings 1.., spokes of rings 2.., every wall
+ * once from the cell on its inner / counter clockwise side.
+ */
+template <typename Geometry>
+inline void sweepPolarWalls(const Sweep& s, const uint8_t* cell_walls, const Geometry& g, SweepHit& hit) {
+    const float cx = g.centerX(), cy = g.centerY();
+    const float ex0 = s.px - cx, ey0 = s.py - cy;
+    const float ex1 = ex0 + s.dx, ey1 = ey0 + s.dy;
+
+    // radii the move covers, the closest point to the center can be in the middle of it
+    const float a = s.dx*s.dx + s.dy*s.dy;
+    float tc = a > 0.0f ? -(ex0*s.dx + ey0*s.dy) / a : 0.0f;
+    if (tc < 0.0f) tc = 0.0f;
+    if (tc > 1.0f) tc = 1.0f;
+    const float mx = ex0 + tc*s.dx, my = ey0 + tc*s.dy;
+    const float r_min = sqrtf(mx*mx + my*my);
+    const float r_max = fmaxf(sqrtf(ex0*ex0 + ey0*ey0), sqrtf(ex1*ex1 + ey1*ey1));
+
+    // ring lo - 1 owns the arc at the inner edge of ring lo
+    int lo = (int)((r_min - s.r) * g.invSpacing()) - 1;
+    int hi = (int)((r_max + s.r) * g.invSpacing());
+    if (lo < 1) lo = 1;
+    if (hi > g.rings() - 1) hi = g.rings() - 1;
+
+    // a straight move turns one way around the center, by less than half a turn
+    const int dir = ex0*s.dy - ey0*s.dx >= 0.0f ? 1 : -1;
+
+    for (int ring = lo; ring <= hi; ++ring) {
+        const int n = g.ringSectors(ring);
+        const int s0 = g.sectorOf(ring, ex0, ey0);
+        const int s1 = g.sectorOf(ring, ex1, ey1);
+        const int turned = dir > 0 ? (s1 - s0 + n) % n : (s0 - s1 + n) % n;
+        // sectors the radius reaches past either end, measured at the ring's inner edge
+        const int margin = 1 + (int)(s.r * n / (6.2832f * ring * g.spacing()));
+        int count = turned + 2 * margin + 1;
+        int sector = ((s0 - dir * margin) % n + n) % n;
+        if (count >= n) { count = n; sector = 0; }
+
+        const float r_in = ring * g.spacing();
+        const float r_out = r_in + g.spacing();
+        for (int i = 0; i < count; ++i, sector = (sector + dir + n) % n) {
+            const uint8_t walls = cell_walls[g.ringStart(ring) + sector];
+            const PolarDir& b0 = g.boundary(ring, sector);
+            const PolarDir& b1 = g.boundary(ring, sector + 1);
+
+            if (g.splitsOut(ring)) {
+                const PolarDir& m = g.middle(ring, sector);
+                if (walls & ARC_OUT) sweepArcSides(s, cx, cy, r_out, b0.x, b0.y, m.x, m.y, hit);
+                if (walls & ARC_OUT_B) sweepArcSides(s, cx, cy, r_out, m.x, m.y, b1.x, b1.y, hit);
+                if (walls & (ARC_OUT | ARC_OUT_B)) sweepPoint(s, cx + r_out * m.x, cy + r_out * m.y, hit);
+            } else if (walls & ARC_OUT) {
+                sweepArcSides(s, cx, cy, r_out, b0.x, b0.y, b1.x, b1.y, hit);
+            }
+            if (walls & (ARC_OUT | ARC_OUT_B)) {
+                sweepPoint(s, cx + r_out * b0.x, cy + r_out * b0.y, hit);
+                sweepPoint(s, cx + r_out * b1.x, cy + r_out * b1.y, hit);
+            }
+            if (ring > 1 && (walls & SPOKE_CCW)) {
+                sweepSegment(s, cx + r_in * b0.x, cy + r_in * b0.y, cx + r_out * b0.x, cy + r_out * b0.y, hit);
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Moves one ball by its pending delta with the selected collision mode, shared by the
+ * Ball and the BallSwarm paths of the runtime and compile time sized mazes
+ * @param ball a Ball or a BallSwarm::Body
+ * @param index wall index for CollisionMode::Indexed, nullptr otherwise
+ */
+template <typename Body, typename Geometry>
+inline void stepPolarBody(Body& ball, const uint8_t* cell_walls, const Geometry& g, CollisionMode mode,
+                          const PolarWallIndex* index, float max_step_px, uint8_t max_substeps) {
+    if (mode == CollisionMode::Swept) {
+        stepBallSwept(ball, [cell_walls, &g](const Sweep& s, SweepHit& hit) {
+            sweepPolarWalls(s, cell_walls, g, hit);
+        });
+        return;
+    }
+    if (index) {
+        stepBallInSubsteps(ball, max_step_px, max_substeps, [index](Body& b) {
+            index->collide(b);
+        });
+        return;
+    }
+    // kernel is called directly, no virtual call per substep
+    stepBallInSubsteps(ball, max_step_px, max_substeps, [cell_walls, &g](Body& b) {
+        collidePolarCell(b, cell_walls, g);
+    });
+}
 
 
 /**
@@ -13,35 +293,66 @@
  *
  * The maze consists of concentric rings subdivided into angular sectors.
  * Walls are stored separately for radial spokes and circular arcs.
+ * In adaptive (theta) mode the sector count doubles going outwards whenever cells would get
+ * more than twice as wide as the ring spacing, so all cells keep roughly the same size.
  */
-class CircularMaze : public Maze {
+class CircularMaze : public Maze, private MazeGrid {
 public:
 
     /**
      * @brief Constructor that accepts dynamic maze dimensions.
      * @param rings The number of concentric rings.
-     * @param sectors The number of sectors per ring.
+     * @param sectors The number of sectors per ring, or of the innermost ring if adaptive.
      * @param spacing The pixel spacing between each ring.
+     * @param adaptive double the sectors outwards to keep cells about equally wide
      */
-    CircularMaze(int rings, int sectors, int spacing);
+    CircularMaze(int rings, int sectors, int spacing, bool adaptive = false);
+
+    virtual ~CircularMaze();
+
+    bool isAdaptive() const { return ADAPTIVE; }
 
     /**
-     * @brief Builds (carves) a new maze layout.
-     * Uses recursive DFS starting at (spawn_ring-1, spawn_sector).
+     * @brief Resets all walls and places the exit, ready to carve a new maze layout.
+     * The selected generator algorithm starts from the exit cell on the outer ring.
      */
-    virtual void generate() override;
+    virtual void beginGenerate() override;
 
     /**
-     * @brief Draws the maze walls and start marker on an LVGL object.
+     * @brief Prepares drawing the maze walls and exit marker on an LVGL object.
      * @param parent  Parent LVGL object for drawing lines and exit.
-     * @param animate If true, renders with a brief pause per wall.
      */
-    virtual void draw(lv_obj_t* parent, bool animate) override;
+    virtual void beginDraw(lv_obj_t* parent) override;
+
+    /**
+     * @brief Adds the next max_walls spokes / arcs to the wall layer, then the exit marker
+     * @param max_walls number of walls to add in this step
+     */
+    virtual bool drawStep(uint32_t max_walls) override;
+
+    virtual MazeId getId() const override;
+
+protected:
+    /**
+     * @brief BFS from the spawn for the stats, then moves the exit to the farthest outer ring cell if requested
+     */
+    virtual void finishGenerate() override;
+
+    const MazeGrid& grid() const override { return *this; }
+
+public:
 
     // Getters for the ball and exit spawn locations
     lv_point_t getBallSpawnPixel() const override { return ball_spawn_px; }
     lv_point_t getExitPixel() const override { return exit_px; }
 
+    /**
+     * @brief Grid cell under a pixel, the open hub counts as ring 1
+     */
+    int cellAtPixel(float x, float y) const override;
+    lv_point_t cellCenterPixel(int cell) const override;
+    int exitCell() const override { return ring_start[NUM_RINGS - 1] - ring_start[1] + exit_sector; }
+
     /**
      * @brief Gets ball position, simple collision check with nearby walls, moves ball outside of collision area, "bouncess" off wall 
      * @param ball Ball object
@@ -57,35 +368,92 @@ public:
     virtual void stepBallWithCollisions(Ball& ball,
                                     float max_step_px = -1.0f,
                                     uint8_t max_substeps = 32) override;
+    virtual void stepSwarmWithCollisions(BallSwarm& swarm,
+                                    float max_step_px = -1.0f,
+                                    uint8_t max_substeps = 32) override;
 
-    
 
 protected:
     int NUM_RINGS; // = 9;
-    int SECTORS_PER_RING; // = 12;
+    int SECTORS_PER_RING; // = 12; sectors of ring 1 when ADAPTIVE
     int RING_SPACING; // = 13;
+    bool ADAPTIVE;
     static constexpr int CENTER_X = 120;
     static constexpr int CENTER_Y = 120;
-    static constexpr int POINTS_PER_ARC = 5;
+    static constexpr int POINTS_PER_ARC = PolarTable::ARC_STEPS;
     // In cirular maze random spawn location of ball on outermost - 1 ring 
     int spawn_ring; /// < Index of the outermost ring (NUM_RINGS-1)
     int spawn_sector;  ///< Sector index where entrance is carved
 
-    std::vector<std::vector<bool>> radial_walls;
-    std::vector<std::vector<bool>> circular_walls;
-    std::vector<std::vector<bool>> visited_circular;
+    // Ring layout, the hub (ring 0) has as many sectors as ring 1.
+    // Without ADAPTIVE every ring has SECTORS_PER_RING and ring_start[r] = r * SECTORS_PER_RING.
+    const PolarTable* table = nullptr;      ///< shared with every maze of the same layout
+    const uint16_t* ring_start = nullptr;   ///< first mask index of each ring, NUM_RINGS + 1 entries
+    const uint16_t* ring_sectors = nullptr; ///< sectors in each ring
+
+    // One PolarWall mask per cell, index = ring_start[ring] + sector (hub ring included).
+    // Shared walls are stored on both sides so a single byte answers every wall query around a cell.
+    uint8_t* cell_walls = nullptr;
+    std::vector<uint8_t> owned_walls; ///< backs cell_walls unless storage was handed in
+    PolarGeometry geometry;
+    PolarWallIndex wall_index;
+    bool wall_index_stale = true;
+
+    /**
+     * @brief Same maze with wall masks kept in wall_storage (ring_start[rings] bytes) instead of the heap
+     */
+    CircularMaze(int rings, int sectors, int spacing, bool adaptive, uint8_t* wall_storage);
+
+    uint8_t wallsAt(int ring, int sector) const { return cell_walls[ring_start[ring] + sector]; }
+
+    /**
+     * @brief Bucketed walls for CollisionMode::Indexed, (re)built on first use after a generate
+     */
+    const PolarWallIndex& wallIndex() {
+        if (wall_index_stale) {
+            wall_index.build(*table, cell_walls, RING_SPACING, CENTER_X, CENTER_Y);
+            wall_index_stale = false;
+        }
+        return wall_index;
+    }
+
+    /**
+     * @brief The wall index if mode is CollisionMode::Indexed, else nullptr
+     */
+    const PolarWallIndex* indexFor(CollisionMode mode) {
+        return mode == CollisionMode::Indexed ? &wallIndex() : nullptr;
+    }
+
+    /**
+     * @brief Ring of a wall mask index (not a grid cell index)
+     */
+    int ringOf(int mask_index) const {
+        if (!ADAPTIVE) return mask_index / SECTORS_PER_RING;
+        int r = 0;
+        while (ring_start[r + 1] <= mask_index) ++r;
+        return r;
+    }
 
     // Exit spawn coord vars
     int exit_sector = 0;
     lv_point_t exit_px = {0,0};
     lv_point_t ball_spawn_px = {CENTER_X, CENTER_Y};
 
+    // MazeGrid view for the generator. The hub (ring 0) is left out,
+    // so cell index = mask index - ring_start[1]
+    int cellCount() const override { return ring_start[NUM_RINGS] - ring_start[1]; }
+    int rowCount() const override { return NUM_RINGS - 1; }
+    int rowStart(int row) const override { return ring_start[row + 1] - ring_start[1]; }
+    int neighbors(int cell, int* out) const override;
+    int openNeighbors(int cell, int* out) const override;
+    int northOf(int cell) const override;
+
     /**
-     * @brief Recursively carve passages using recursive DFS.
-     * @param ring   Current ring index (0 = center).
-     * @param sector Current sector index.
+     * @brief Knocks down the arc or spoke between two adjacent cells
+     * @param a cell index
+     * @param b cell index of a neighbour of a
      */
-    void carve(int ring, int sector);
+    void link(int a, int b) override;
 
     
      /**
@@ -93,13 +461,40 @@ protected:
      */
     void placeExitAndSpawn();
 
+    /**
+     * @brief Moves the exit to sector s of the outer ring and updates its pixel position
+     */
+    void setExitSector(int s);
+
 
-    // Pre-allocated buffers for LVGL line drawing (two endpoints or arc points)
-    //static constexpr int MAX_TOTAL_WALLS = (NUM_RINGS * SECTORS_PER_RING) * 2 + 1;
-    static constexpr int MAX_POINTS_PER_LINE = POINTS_PER_ARC + 1;
-    std::vector<std::array<lv_point_t, MAX_POINTS_PER_LINE>> point_buffer;
-    //static lv_point_t point_buffer[MAX_TOTAL_WALLS][MAX_POINTS_PER_LINE];
-    int wall_buffer_idx; ///< Next free index in point_buffer
+    // Incremental drawing state
+    lv_obj_t* draw_parent = nullptr;
+    int draw_cursor = 0; ///< next wall slot, spokes first then arcs
+
+    /**
+     * @brief Adds one spoke line to the wall layer
+     * @param dir spoke direction from the table
+     * @param r1 inner radius in px
+     * @param r2 outer radius in px
+     */
+    void addSpoke(const PolarDir& dir, float r1, float r2);
+
+    /**
+     * @brief Adds the outer arc of cell (ring, sector) to the wall layer
+     */
+    void addArc(int ring, int sector) { addArc((ring + 1) * RING_SPACING, ring, sector); }
+
+    /**
+     * @brief Adds the arc spanning sector of ring's sector division at radius to the wall layer
+     */
+    void addArc(float radius, int ring, int sector);
+
+    /**
+     * @brief Screen position at radius along dir
+     */
+    static lv_point_t polarPixel(const PolarDir& dir, float radius) {
+        return { (lv_coord_t)(CENTER_X + dir.x * radius), (lv_coord_t)(CENTER_Y + dir.y * radius) };
+    }
 
   
 };
@@ -0,0 +1,55 @@
+#include "DrawAnimator.h"
+#include "maze.h"
+#include <Arduino.h>
+
+
+void DrawAnimator::start(Maze& m, lv_obj_t* parent) {
+    stop();
+    maze = &m;
+    maze->beginDraw(parent);
+}
+
+
+void DrawAnimator::startOnTimer(Maze& m, lv_obj_t* parent) {
+    start(m, parent);
+    timer = lv_timer_create(timerCallback, period_ms, this);
+}
+
+
+bool DrawAnimator::frame() {
+    if (!maze) return true;
+
+    const uint32_t start_us = micros();
+    uint32_t left = walls_per_frame ? walls_per_frame : UINT32_MAX;
+    bool done = false;
+    while (left > 0) {
+        const uint32_t n = left < CHUNK ? left : CHUNK;
+        left -= n;
+        if (maze->drawStep(n)) { done = true; break; }
+        if (budget_us && micros() - start_us >= budget_us) break;
+    }
+    if (!done) return false;
+
+    // stop() first, the callback may start the next animation or delete the maze (and us with it)
+    Maze* finished = maze;
+    DoneCallback cb = callback;
+    void* cb_data = callback_data;
+    stop();
+    if (cb) cb(*finished, cb_data);
+    return true;
+}
+
+
+void DrawAnimator::stop() {
+    if (timer) {
+        lv_timer_del(timer);
+        timer = nullptr;
+    }
+    maze = nullptr;
+}
+
+
+void DrawAnimator::timerCallback(lv_timer_t* t) {
+    DrawAnimator* self = (DrawAnimator*)t->user_data;
+    self->frame();
+}
@@ -0,0 +1,84 @@
+#ifndef DRAW_ANIMATOR_H
+#define DRAW_ANIMATOR_H
+
+#include <lvgl.h>
+#include <stdint.h>
+
+class Maze;
+
+/**
+ * @class DrawAnimator
+ * @brief Animated maze drawing that never blocks: every frame adds a few walls through
+ * Maze::drawStep and returns, the walls show up with the next regular screen refresh.
+ *
+ * Frames come either from frame() called in the main loop or from an LVGL timer
+ * (runOnTimer), so the speed is set by walls per frame and the frame period instead of by
+ * how long a full display flush takes.
+ */
+class DrawAnimator {
+public:
+    /**
+     * @brief Called once when the last wall (and the exit marker) is on the screen
+     */
+    typedef void (*DoneCallback)(Maze& maze, void* user_data);
+
+    ~DrawAnimator() { stop(); }
+
+    // the LVGL timer holds a pointer back to this animator
+    DrawAnimator() {}
+    DrawAnimator(const DrawAnimator&) = delete;
+    DrawAnimator& operator=(const DrawAnimator&) = delete;
+
+    /**
+     * @param walls_per_frame walls added per frame, 0 for as many as the budget allows
+     * @param budget_us time one frame may spend adding walls, 0 for no limit
+     * @param period_ms frame period when running on the LVGL timer
+     */
+    void configure(uint16_t walls_per_frame, uint32_t budget_us, uint32_t period_ms) {
+        this->walls_per_frame = walls_per_frame;
+        this->budget_us = budget_us;
+        this->period_ms = period_ms;
+    }
+
+    void setDoneCallback(DoneCallback cb, void* user_data) { callback = cb; callback_data = user_data; }
+
+    /**
+     * @brief Calls beginDraw on the maze, no wall is added yet
+     */
+    void start(Maze& maze, lv_obj_t* parent);
+
+    /**
+     * @brief start() and then one frame() every period_ms from an LVGL timer
+     */
+    void startOnTimer(Maze& maze, lv_obj_t* parent);
+
+    /**
+     * @brief Adds one frame's worth of walls
+     * @return true once the maze is complete (or nothing is being drawn)
+     */
+    bool frame();
+
+    /**
+     * @brief Stops where it is, the walls drawn so far stay
+     */
+    void stop();
+
+    bool isRunning() const { return maze != nullptr; }
+
+private:
+    // walls per drawStep call, so the budget is checked a few times per frame
+    static constexpr uint32_t CHUNK = 4;
+
+    Maze* maze = nullptr;
+    lv_timer_t* timer = nullptr;
+    uint16_t walls_per_frame = 4;
+    uint32_t budget_us = 2000;
+    uint32_t period_ms = 16;
+
+    DoneCallback callback = nullptr;
+    void* callback_data = nullptr;
+
+    static void timerCallback(lv_timer_t* t);
+};
+
+#endif // DRAW_ANIMATOR_H
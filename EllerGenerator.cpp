@@ -0,0 +1,101 @@
+#include "EllerGenerator.h"
+#include <algorithm>
+
+void EllerGenerator::begin(int c, int r, MazeRandom& random_source) {
+    rng = &random_source;
+    cols = c;
+    rows = r;
+    row = 0;
+
+    // at most cols sets are alive at once, 2 * cols labels always leaves a free one
+    set.assign(cols, 0);
+    parent.assign(2 * cols, 0);
+    members.assign(2 * cols, 0);
+    down.assign(cols, 0);
+    walls.assign(cols, 0);
+}
+
+
+int EllerGenerator::findLabel(int l) {
+    while (parent[l] != l) {
+        parent[l] = parent[parent[l]];
+        l = parent[l];
+    }
+    return l;
+}
+
+
+bool EllerGenerator::nextRow() {
+    if (row >= rows || cols <= 0 || !rng) return false;
+    const bool last = (row == rows - 1);
+
+    // Cells reached from above keep their set, every other cell starts a new one.
+    // members is used as a "label taken" flag here, it is recounted in the down pass.
+    std::fill(members.begin(), members.end(), 0);
+    for (int c = 0; c < cols; ++c) {
+        if (down[c]) members[set[c]] = 1;
+    }
+    int free_label = 0;
+    for (int c = 0; c < cols; ++c) {
+        walls[c] = down[c] ? 0 : WALL_N;
+        if (down[c]) continue;
+        while (members[free_label]) ++free_label;
+        set[c] = free_label;
+        members[free_label] = 1;
+    }
+    for (int l = 0; l < 2 * cols; ++l) parent[l] = l;
+
+    // Join neighbours of different sets at random, the last row joins all of them
+    walls[0] |= WALL_W;
+    walls[cols - 1] |= WALL_E;
+    for (int c = 0; c + 1 < cols; ++c) {
+        int a = findLabel(set[c]);
+        int b = findLabel(set[c + 1]);
+        if (a != b && (last || rng->coin())) {
+            parent[b] = a;
+        } else {
+            walls[c] |= WALL_E;
+            walls[c + 1] |= WALL_W;
+        }
+    }
+    for (int c = 0; c < cols; ++c) set[c] = findLabel(set[c]);
+
+    if (last) {
+        for (int c = 0; c < cols; ++c) walls[c] |= WALL_S;
+        ++row;
+        return true;
+    }
+
+    // Carve down at random, but every set needs at least one way down.
+    // parent is free again after the flattening above and now flags sets that went down.
+    std::fill(members.begin(), members.end(), 0);
+    for (int c = 0; c < cols; ++c) {
+        ++members[set[c]];
+        parent[set[c]] = 0;
+    }
+    for (int c = 0; c < cols; ++c) {
+        int l = set[c];
+        --members[l];
+        bool carve = rng->coin() || (members[l] == 0 && !parent[l]);
+        down[c] = carve;
+        if (carve) parent[l] = 1;
+        else walls[c] |= WALL_S;
+    }
+
+    ++row;
+    return true;
+}
+
+
+void EllerGenerator::run(int c, int r, MazeRandom& random_source, MazeRowCallback callback, void* user_data) {
+    begin(c, r, random_source);
+    while (nextRow()) {
+        if (callback) callback(rowIndex(), rowWalls(), cols, user_data);
+    }
+}
+
+
+size_t EllerGenerator::workingBytes() const {
+    return (set.capacity() + parent.capacity() + members.capacity()) * sizeof(int)
+         + down.capacity() + walls.capacity();
+}
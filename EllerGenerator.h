@@ -0,0 +1,80 @@
+#ifndef ELLER_GENERATOR_H
+#define ELLER_GENERATOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "MazeRandom.h"
+
+/**
+ * @brief Wall bits of one rectangular cell, a set bit means the wall is up
+ */
+enum RectWall : uint8_t {
+    WALL_N = 1 << 0,
+    WALL_S = 1 << 1,
+    WALL_W = 1 << 2,
+    WALL_E = 1 << 3
+};
+
+/**
+ * @brief Called once per finished row
+ * @param row row index, starting at 0 from the top
+ * @param walls one RectWall mask per column, only valid during the call
+ * @param cols number of columns
+ * @param user_data pointer handed to the generator
+ */
+typedef void (*MazeRowCallback)(int row, const uint8_t* walls, int cols, void* user_data);
+
+/**
+ * @class EllerGenerator
+ * @brief Streams a rectangular perfect maze one row at a time with Eller's algorithm.
+ *
+ * Only the current row is kept in memory (a few bytes per column), so the number of rows
+ * is unbounded and the first row is available right away.
+ */
+class EllerGenerator {
+public:
+    /**
+     * @brief Prepares a new maze
+     * @param cols number of columns
+     * @param rows number of rows, the last row closes every open set
+     * @param rng random source, has to outlive the generation
+     */
+    void begin(int cols, int rows, MazeRandom& rng);
+
+    /**
+     * @brief Generates the next row, readable through rowWalls() until the next call
+     * @return false once every row has been produced
+     */
+    bool nextRow();
+
+    const uint8_t* rowWalls() const { return walls.data(); }
+    int rowIndex() const { return row - 1; }
+    int columns() const { return cols; }
+
+    /**
+     * @brief Generates all rows and hands each one to callback
+     */
+    void run(int cols, int rows, MazeRandom& rng, MazeRowCallback callback, void* user_data);
+
+    /**
+     * @brief Bytes held by the row buffers
+     */
+    size_t workingBytes() const;
+
+private:
+    int cols = 0;
+    int rows = 0;
+    int row = 0;
+    MazeRandom* rng = nullptr;
+
+    std::vector<int> set;        ///< set label of each column
+    std::vector<int> parent;     ///< union-find over labels, 2 * cols entries
+    std::vector<int> members;    ///< cells per label left to visit in the down pass
+    std::vector<uint8_t> down;   ///< column carved down in the previous row
+    std::vector<uint8_t> walls;  ///< RectWall masks of the current row
+
+    int findLabel(int l);
+};
+
+#endif // ELLER_GENERATOR_H
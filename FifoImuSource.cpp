@@ -0,0 +1,95 @@
+#include "FifoImuSource.h"
+
+
+bool FifoImuSource::begin() {
+    if (!bus.begin()) return false;
+    uint8_t id = 0;
+    if (!bus.readRegisters(WHO_AM_I, &id, 1)) return false;
+    if (id != 0x69 && id != 0x6A) return false; // LSM6DS3, LSM6DS3TR-C
+
+    // block data update, register address auto increment
+    bus.writeRegister(CTRL3_C, 0x44);
+    // 416 Hz, +-2 g / +-2000 dps
+    bus.writeRegister(CTRL1_XL, 0x60);
+    bus.writeRegister(CTRL2_G, 0x6C);
+    // gyro and accelerometer into the FIFO, no decimation
+    bus.writeRegister(FIFO_CTRL3, 0x09);
+    restartFifo();
+    return true;
+}
+
+
+void FifoImuSource::restartFifo() {
+    bus.writeRegister(FIFO_CTRL5, FIFO_BYPASS);
+    bus.writeRegister(FIFO_CTRL5, FIFO_CONTINUOUS_416HZ);
+}
+
+
+void FifoImuSource::drain() {
+    // FIFO_STATUS1..4: unread words, overrun, next word in the pattern
+    uint8_t status[4];
+    if (!bus.readRegisters(FIFO_STATUS1, status, 4)) return;
+    const int words = status[0] | ((status[1] & 0x0F) << 8);
+    const bool overrun = status[1] & 0x40;
+    const int pattern = (status[2] | ((status[3] & 0x03) << 8)) % WORDS_PER_SAMPLE;
+
+    // finish a sample a previous drain left half read, then whole samples only
+    const int skip = (WORDS_PER_SAMPLE - pattern) % WORDS_PER_SAMPLE;
+
+    // the newest samples are at the end, rather than read a long backlog start over and
+    // use the last batch once more
+    if (overrun || words - skip > MAX_SAMPLES * WORDS_PER_SAMPLE) {
+        restartFifo();
+        ++overflow_count;
+        accel_cursor = count;
+        return;
+    }
+
+    const int samples = (words - skip) / WORDS_PER_SAMPLE;
+    if (samples <= 0) {
+        // nothing new since the last drain, the gyro keeps its last sample
+        accel_cursor = 0;
+        return;
+    }
+    const size_t total = (size_t)(skip + samples * WORDS_PER_SAMPLE) * 2;
+
+    // bursts of whole words
+    const size_t chunk = bus.maxRead() & ~(size_t)1;
+    for (size_t at = 0; at < total; at += chunk) {
+        const size_t n = total - at < chunk ? total - at : chunk;
+        if (!bus.readRegisters(FIFO_DATA_OUT_L, raw + at, n)) {
+            count = accel_cursor = 0;
+            return;
+        }
+    }
+
+    const uint8_t* p = raw + skip * 2;
+    for (int i = 0; i < samples; ++i) {
+        for (int k = 0; k < 3; ++k, p += 2) gyro[i][k] = (int16_t)(p[0] | (p[1] << 8));
+        for (int k = 0; k < 3; ++k, p += 2) accel[i][k] = (int16_t)(p[0] | (p[1] << 8));
+    }
+    count = accel_cursor = samples;
+}
+
+
+void FifoImuSource::readGyro(float& x, float& y, float& z) {
+    drain();
+    if (count == 0) {
+        x = y = z = 0.0f;
+        return;
+    }
+    const int16_t* g = gyro[count - 1];
+    x = g[0] * GYRO_DPS_PER_LSB;
+    y = g[1] * GYRO_DPS_PER_LSB;
+    z = g[2] * GYRO_DPS_PER_LSB;
+}
+
+
+bool FifoImuSource::readAccel(float& x, float& y, float& z) {
+    if (accel_cursor == 0) return false;
+    const int16_t* a = accel[--accel_cursor];
+    x = a[0] * ACCEL_G_PER_LSB;
+    y = a[1] * ACCEL_G_PER_LSB;
+    z = a[2] * ACCEL_G_PER_LSB;
+    return true;
+}
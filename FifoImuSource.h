@@ -0,0 +1,75 @@
+#ifndef FIFO_IMU_SOURCE_H
+#define FIFO_IMU_SOURCE_H
+
+#include <stdint.h>
+#include "ImuSource.h"
+#include "ImuBus.h"
+
+/**
+ * @class FifoImuSource
+ * @brief LSM6DS3 (or LSM6DS3TR-C) sampling into its FIFO at a fixed rate, read in bursts.
+ *
+ * begin() sets gyro and accelerometer to ODR_HZ and the FIFO to continuous mode with both in
+ * it. readGyro() drains the FIFO: one transaction for the status registers, then the data in
+ * bursts of the bus's maxRead() bytes (the address wraps from FIFO_DATA_OUT_H back to _L),
+ * and returns the newest gyro sample. readAccel() then hands out the accelerometer samples of
+ * that batch newest first, and false once they are used up, so IMU::read() averages what
+ * arrived since the last frame instead of making a bus round trip per reading.
+ * A backlog of more than MAX_SAMPLES (after a stall) is thrown away, not read, and the last
+ * batch is handed out once more; an empty FIFO has no accelerometer samples to hand out.
+ */
+class FifoImuSource : public ImuSource {
+public:
+    static constexpr uint16_t ODR_HZ = 416;
+    // Samples kept from one drain, 77 ms at ODR_HZ, far more than one frame
+    static constexpr int MAX_SAMPLES = 32;
+    // Scales of the ranges begin() sets: +-2 g and +-2000 dps
+    static constexpr float ACCEL_G_PER_LSB = 0.061f / 1000.0f;
+    static constexpr float GYRO_DPS_PER_LSB = 70.0f / 1000.0f;
+
+    // Registers used
+    static constexpr uint8_t FIFO_CTRL3 = 0x08;
+    static constexpr uint8_t FIFO_CTRL5 = 0x0A;
+    static constexpr uint8_t WHO_AM_I = 0x0F;
+    static constexpr uint8_t CTRL1_XL = 0x10;
+    static constexpr uint8_t CTRL2_G = 0x11;
+    static constexpr uint8_t CTRL3_C = 0x12;
+    static constexpr uint8_t FIFO_STATUS1 = 0x3A;
+    static constexpr uint8_t FIFO_DATA_OUT_L = 0x3E;
+    // FIFO_CTRL5 values: bypass empties the FIFO, continuous keeps the newest samples
+    static constexpr uint8_t FIFO_BYPASS = 0x00;
+    static constexpr uint8_t FIFO_CONTINUOUS_416HZ = (0x6 << 3) | 0x6;
+
+    explicit FifoImuSource(ImuBus& bus) : bus(bus) {}
+
+    bool begin() override;
+    void readGyro(float& x, float& y, float& z) override;
+    bool readAccel(float& x, float& y, float& z) override;
+
+    /**
+     * @brief Samples the last drain returned, and the times the backlog was thrown away
+     */
+    int lastBatch() const { return count; }
+    uint32_t overflows() const { return overflow_count; }
+
+private:
+    // FIFO words in the order they come out: gyro x y z, then accelerometer x y z
+    static constexpr int WORDS_PER_SAMPLE = 6;
+
+    ImuBus& bus;
+    uint8_t raw[(WORDS_PER_SAMPLE - 1 + MAX_SAMPLES * WORDS_PER_SAMPLE) * 2]; ///< one drain, room for the rest of a partial sample in front
+    int16_t gyro[MAX_SAMPLES][3];
+    int16_t accel[MAX_SAMPLES][3];
+    int count = 0;          ///< samples in gyro / accel, oldest first
+    int accel_cursor = 0;   ///< accelerometer samples not handed out yet
+    uint32_t overflow_count = 0;
+
+    void drain();
+
+    /**
+     * @brief Empties the FIFO by switching it to bypass and back
+     */
+    void restartFifo();
+};
+
+#endif // FIFO_IMU_SOURCE_H
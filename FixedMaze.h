@@ -0,0 +1,131 @@
+#ifndef FIXED_MAZE_H
+#define FIXED_MAZE_H
+
+#include "RectangularMaze.h"
+#include "CircularMaze.h"
+
+// Set to 0 to build every maze with the runtime sized classes
+#ifndef MAZE_FIXED_GEOMETRY
+#define MAZE_FIXED_GEOMETRY 1
+#endif
+
+/**
+ * @brief Compile time counterpart of RectGeometry, every division folds into a constant
+ */
+template <int COLS, int ROWS, int CELL_SIZE, int OFFSET>
+struct FixedRectGeometry {
+    static constexpr int cols() { return COLS; }
+    static constexpr int rows() { return ROWS; }
+    static constexpr int cell() { return CELL_SIZE; }
+    static constexpr int offset() { return OFFSET; }
+    static constexpr float invCell() { return 1.0f / CELL_SIZE; }
+    static constexpr BallScalar ballInvCell() { return BallScalar(1.0f / CELL_SIZE); }
+};
+
+/**
+ * @brief Compile time counterpart of PolarGeometry, uniform rings only. Every ring has the
+ * same directions, so they are read from a single ring of the shared table.
+ */
+template <int RINGS, int SECTORS, int SPACING>
+struct FixedPolarGeometry {
+    const PolarDir* arc_dirs; ///< arc points of ring 0 in the table, all rings share them
+    const BallDir* ball_dirs; ///< the same in the ball's format
+
+    explicit FixedPolarGeometry(const PolarTable* table)
+        : arc_dirs(&table->arcPoint(0, 0)), ball_dirs(&table->ballArcPoint(0, 0)) {}
+
+    static constexpr int rings() { return RINGS; }
+    static constexpr int spacing() { return SPACING; }
+    static constexpr float invSpacing() { return 1.0f / SPACING; }
+    static constexpr BallScalar ballInvSpacing() { return BallScalar(1.0f / SPACING); }
+    static constexpr int ringSectors(int) { return SECTORS; }
+    static constexpr int ringStart(int ring) { return ring * SECTORS; }
+    static constexpr bool splitsOut(int) { return false; }
+    // the search runs a constant number of rounds, so it unrolls
+    int sectorOf(int, float dx, float dy) const { return PolarTable::sectorIn(arc_dirs, SECTORS, dx, dy); }
+    const PolarDir& boundary(int, int s) const { return arc_dirs[s * PolarTable::ARC_STEPS]; }
+    const PolarDir& middle(int, int s) const { return arc_dirs[SECTORS * PolarTable::ARC_STEPS + 1 + s]; }
+    int ballSectorOf(int, BallScalar dx, BallScalar dy) const { return PolarTable::sectorIn(ball_dirs, SECTORS, dx, dy); }
+    const BallDir& ballBoundary(int, int s) const { return ball_dirs[s * PolarTable::ARC_STEPS]; }
+    const BallDir& ballMiddle(int, int s) const { return ball_dirs[SECTORS * PolarTable::ARC_STEPS + 1 + s]; }
+    static constexpr int centerX() { return 120; }
+    static constexpr int centerY() { return 120; }
+};
+
+/**
+ * @class FixedRectangularMaze
+ * @brief RectangularMaze with its size fixed at compile time.
+ *
+ * Wall masks live in an array inside the object instead of on the heap, and the collision
+ * substeps call the shared kernel with constexpr dimensions, inlined, without any virtual call.
+ * Mazes are identical to the runtime class for the same id.
+ */
+template <int Cols, int Rows, int CellSize, int Offset>
+class FixedRectangularMaze final : public RectangularMaze {
+public:
+    FixedRectangularMaze() : RectangularMaze(Cols, Rows, CellSize, Offset, wall_store) {}
+
+    void handleCollisions(Ball& ball) override {
+        if (const WallDistanceField* field = fieldFor(collision_mode)) field->collide(ball);
+        else collideRectCell(ball, wall_store, Geometry());
+    }
+
+    void stepBallWithCollisions(Ball& ball, float max_step_px = -1.0f, uint8_t max_substeps = 32) override {
+        if (const WallDistanceField* field = fieldFor(collision_mode)) stepFieldBody(ball, *field, max_step_px, max_substeps);
+        else stepRectBody(ball, wall_store, Geometry(), collision_mode, max_step_px, max_substeps);
+    }
+
+    void stepSwarmWithCollisions(BallSwarm& swarm, float max_step_px = -1.0f, uint8_t max_substeps = 32) override {
+        const WallDistanceField* field = fieldFor(collision_mode);
+        swarm.forEachBody([&](BallSwarm::Body& b) {
+            if (field) stepFieldBody(b, *field, max_step_px, max_substeps);
+            else stepRectBody(b, wall_store, Geometry(), collision_mode, max_step_px, max_substeps);
+        });
+    }
+
+private:
+    typedef FixedRectGeometry<Cols, Rows, CellSize, Offset> Geometry;
+    uint8_t wall_store[Cols * Rows];
+};
+
+/**
+ * @class FixedCircularMaze
+ * @brief CircularMaze with its size fixed at compile time, see FixedRectangularMaze
+ */
+template <int Rings, int Sectors, int Spacing>
+class FixedCircularMaze final : public CircularMaze {
+public:
+    FixedCircularMaze() : CircularMaze(Rings, Sectors, Spacing, /*adaptive=*/false, wall_store) {}
+
+    void handleCollisions(Ball& ball) override {
+        if (const WallDistanceField* field = fieldFor(collision_mode)) field->collide(ball);
+        else if (collision_mode == CollisionMode::Indexed) wallIndex().collide(ball);
+        else collidePolarCell(ball, wall_store, Geometry(table));
+    }
+
+    void stepBallWithCollisions(Ball& ball, float max_step_px = -1.0f, uint8_t max_substeps = 32) override {
+        if (const WallDistanceField* field = fieldFor(collision_mode)) stepFieldBody(ball, *field, max_step_px, max_substeps);
+        else stepPolarBody(ball, wall_store, Geometry(table), collision_mode, indexFor(collision_mode), max_step_px, max_substeps);
+    }
+
+    void stepSwarmWithCollisions(BallSwarm& swarm, float max_step_px = -1.0f, uint8_t max_substeps = 32) override {
+        const Geometry g(table);
+        const WallDistanceField* field = fieldFor(collision_mode);
+        const PolarWallIndex* index = indexFor(collision_mode);
+        swarm.forEachBody([&](BallSwarm::Body& b) {
+            if (field) stepFieldBody(b, *field, max_step_px, max_substeps);
+            else stepPolarBody(b, wall_store, g, collision_mode, index, max_step_px, max_substeps);
+        });
+    }
+
+private:
+    typedef FixedPolarGeometry<Rings, Sectors, Spacing> Geometry;
+    uint8_t wall_store[Rings * Sectors];
+};
+
+// Configurations the sketch ships with (see mazeIdFor in maze_game.ino), createMaze picks
+// these whenever an id matches them
+typedef FixedRectangularMaze<10, 10, 16, 40> ShippingRectangularMaze;
+typedef FixedCircularMaze<10, 16, 11> ShippingCircularMaze;
+
+#endif // FIXED_MAZE_H
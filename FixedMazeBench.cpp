@@ -0,0 +1,98 @@
+// Host benchmark of the compile time sized mazes (FixedMaze.h) against the runtime sized
+// classes, not part of the sketch (the Arduino build compiles this file to nothing). Nothing
+// is drawn, but the maze classes link against LVGL, so this needs the host setup of the trace
+// replay (see TraceRunner.h): LVGL 8.3 with an lv_conf.h and an Arduino.h providing micros().
+// Build and run on a PC:
+//
+//   g++ -std=gnu++11 -O2 -I. -I<lvgl> -I<Arduino.h> -o fixed_bench FixedMazeBench.cpp $MAZE_SOURCES <LVGL library>
+//   ./fixed_bench
+//
+// where MAZE_SOURCES is Ball.cpp BallSwarm.cpp PhysicsClock.cpp RectangularMaze.cpp CircularMaze.cpp
+// MazeGenerator.cpp EllerGenerator.cpp MazeAnalyzer.cpp PolarTable.cpp PolarWallIndex.cpp
+// WallDistanceField.cpp WallLayer.cpp DrawAnimator.cpp
+//
+// Rolls a ball through the shipping 10x10 rectangular and 10 ring circular mazes with the same
+// scripted tilt, once in the runtime class and once in its fixed twin, both through a Maze
+// pointer like the sketch. Prints the time per physics step (one stepBallWithCollisions call,
+// all its substeps) and checks that both classes move the ball the same way.
+
+#ifndef ARDUINO
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "FixedMaze.h"
+
+static const uint32_t SEED = 1234;
+static const int STEPS = 240 * 3600; // an hour of play at 240 Hz
+static const int TILT_EVERY = 120;   // steps between tilt changes
+
+/**
+ * @brief Runs the scripted tilt through maze
+ * @param ms set to the milliseconds spent in updatePhysics and stepBallWithCollisions
+ * @return FNV-1a hash over the ball position after every step
+ */
+static uint32_t roll(Maze& maze, double& ms) {
+    const lv_point_t spawn = maze.getBallSpawnPixel();
+    Ball ball(nullptr, spawn.x, spawn.y, 5.0f);
+    MazeRandom tilt(SEED);
+    float roll = 0.0f, pitch = 0.0f;
+    uint32_t hash = 2166136261u;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < STEPS; ++i) {
+        if (i % TILT_EVERY == 0) {
+            roll = tilt.below(6001) / 100.0f - 30.0f;
+            pitch = tilt.below(6001) / 100.0f - 30.0f;
+        }
+        ball.updatePhysics(roll, pitch);
+        maze.stepBallWithCollisions(ball, ball.getRadius() * 0.5f, 24);
+
+        const float pos[2] = { ball.getX(), ball.getY() };
+        const uint8_t* p = (const uint8_t*)pos;
+        for (size_t k = 0; k < sizeof(pos); ++k) hash = (hash ^ p[k]) * 16777619u;
+    }
+    ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return hash;
+}
+
+
+/**
+ * @brief Times one runtime / fixed pair, true if both took the same path
+ */
+static bool compare(const char* name, Maze& runtime, Maze& fixed, size_t runtime_size, size_t fixed_size) {
+    runtime.setSeed(SEED);
+    runtime.generate();
+    fixed.setSeed(SEED);
+    fixed.generate();
+
+    double runtime_ms, fixed_ms;
+    const uint32_t runtime_hash = roll(runtime, runtime_ms);
+    const uint32_t fixed_hash = roll(fixed, fixed_ms);
+    const bool same = runtime_hash == fixed_hash;
+
+    printf("%-12s %-8s %12.1f %12zu\n", name, "runtime", 1e6 * runtime_ms / STEPS, runtime_size);
+    printf("%-12s %-8s %12.1f %12zu   %.2fx, %s\n", name, "fixed", 1e6 * fixed_ms / STEPS, fixed_size,
+           runtime_ms / fixed_ms, same ? "same path" : "PATHS DIFFER");
+    fflush(stdout);
+    return same;
+}
+
+
+int main() {
+    int failures = 0;
+    printf("%-12s %-8s %12s %12s\n", "maze", "class", "ns / step", "object bytes");
+
+    // the runtime classes keep their walls on the heap, the object size leaves them out
+    RectangularMaze rect(10, 10, 16, 40);
+    ShippingRectangularMaze fixed_rect;
+    if (!compare("rect 10x10", rect, fixed_rect, sizeof(rect), sizeof(fixed_rect))) ++failures;
+
+    CircularMaze circ(10, 16, 11);
+    ShippingCircularMaze fixed_circ;
+    if (!compare("circ 10x16", circ, fixed_circ, sizeof(circ), sizeof(fixed_circ))) ++failures;
+
+    return failures == 0 ? 0 : 1;
+}
+
+#endif // ARDUINO
@@ -0,0 +1,118 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+#include <math.h>
+
+// 1 keeps the ball (position, velocity, integration) and the substep collision kernels of the
+// rectangular and circular mazes in Q16.16 fixed point, for boards without an FPU such as the
+// RP2040 and the SAMD21. Swept, indexed and graph maze collision and all drawing stay in float.
+#ifndef MAZE_FIXED_POINT
+#define MAZE_FIXED_POINT 0
+#endif
+
+/**
+ * @brief Signed Q16.16 fixed point number, +-32768 in steps of 1/65536.
+ *
+ * Ball coordinates stay within the 240 px screen and speeds within a few hundred, the largest
+ * value the kernels build is a squared distance from the maze center, at most 2 * 120^2.
+ * Products are rounded to nearest, conversions from and to float are explicit so a float
+ * never sneaks into the fixed point path.
+ */
+struct Q16 {
+    static constexpr int32_t ONE = 65536;
+
+    int32_t raw;
+
+    Q16() = default;
+    constexpr explicit Q16(int v) : raw(v * ONE) {}
+    constexpr explicit Q16(float v) : raw((int32_t)(v * ONE + (v < 0.0f ? -0.5f : 0.5f))) {}
+
+    static constexpr Q16 fromRaw(int32_t r) { return Q16(r, RawTag()); }
+
+    constexpr explicit operator float() const { return raw * (1.0f / ONE); }
+    // truncates towards zero like a float to int cast
+    constexpr explicit operator int() const { return raw >= 0 ? raw / ONE : -(-raw / ONE); }
+
+    constexpr Q16 operator-() const { return fromRaw(-raw); }
+    constexpr Q16 operator+(Q16 b) const { return fromRaw(raw + b.raw); }
+    constexpr Q16 operator-(Q16 b) const { return fromRaw(raw - b.raw); }
+    constexpr Q16 operator*(Q16 b) const { return fromRaw((int32_t)(((int64_t)raw * b.raw + ONE / 2) >> 16)); }
+    constexpr Q16 operator/(Q16 b) const { return fromRaw((int32_t)((int64_t)raw * ONE / b.raw)); }
+    constexpr Q16 operator/(int d) const { return fromRaw(raw / d); }
+
+    Q16& operator+=(Q16 b) { raw += b.raw; return *this; }
+    Q16& operator-=(Q16 b) { raw -= b.raw; return *this; }
+    Q16& operator*=(Q16 b) { return *this = *this * b; }
+
+    constexpr bool operator<(Q16 b) const { return raw < b.raw; }
+    constexpr bool operator>(Q16 b) const { return raw > b.raw; }
+    constexpr bool operator<=(Q16 b) const { return raw <= b.raw; }
+    constexpr bool operator>=(Q16 b) const { return raw >= b.raw; }
+    constexpr bool operator==(Q16 b) const { return raw == b.raw; }
+    constexpr bool operator!=(Q16 b) const { return raw != b.raw; }
+
+private:
+    struct RawTag {};
+    constexpr Q16(int32_t r, RawTag) : raw(r) {}
+};
+
+inline Q16 scalarAbs(Q16 v) { return v.raw < 0 ? -v : v; }
+
+/**
+ * @brief Square root, bit by bit on integers: 24 rounds of shifts and compares, no division
+ */
+inline Q16 scalarSqrt(Q16 v) {
+    if (v.raw <= 0) return Q16(0);
+    uint64_t n = (uint64_t)v.raw << 16; // sqrt(raw * 65536) is the raw result
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 46;   // highest power of four n can reach
+    while (bit > n) bit >>= 2;
+    while (bit) {
+        if (n >= root + bit) {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return Q16::fromRaw((int32_t)root);
+}
+
+/**
+ * @brief (dx, dy) / len for |dx|, |dy| <= len. 1 / len in Q16 keeps only ten bits or so once
+ * len is a hundred pixels, so the reciprocal is taken in Q32: one division for both components.
+ */
+inline void scalarUnit(Q16 dx, Q16 dy, Q16 len, Q16& ux, Q16& uy) {
+    const int64_t inv = ((int64_t)1 << 48) / len.raw;
+    ux = Q16::fromRaw((int32_t)((dx.raw * inv + ((int64_t)1 << 31)) >> 32));
+    uy = Q16::fromRaw((int32_t)((dy.raw * inv + ((int64_t)1 << 31)) >> 32));
+}
+
+/**
+ * @brief ceil(a / b) for a >= 0, b > 0
+ */
+inline int scalarCeilDiv(Q16 a, Q16 b) { return (a.raw + b.raw - 1) / b.raw; }
+
+inline float toFloat(Q16 v) { return (float)v; }
+
+// float counterparts, so code written against BallScalar reads the same in both builds
+inline float scalarAbs(float v) { return fabsf(v); }
+inline float scalarSqrt(float v) { return sqrtf(v); }
+inline int scalarCeilDiv(float a, float b) { return (int)ceilf(a / b); }
+inline void scalarUnit(float dx, float dy, float len, float& ux, float& uy) {
+    const float inv = 1.0f / len;
+    ux = dx * inv;
+    uy = dy * inv;
+}
+inline float toFloat(float v) { return v; }
+
+// Number format of the ball and the substep kernels
+#if MAZE_FIXED_POINT
+typedef Q16 BallScalar;
+#else
+typedef float BallScalar;
+#endif
+
+#endif // FIXED_POINT_H
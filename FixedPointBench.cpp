@@ -0,0 +1,173 @@
+// Host benchmark of the Q16.16 ball build (MAZE_FIXED_POINT=1) against the float build, not
+// part of the sketch (the Arduino build compiles this file to nothing). BallScalar is one type
+// per build, so this file is built twice: the float build records every physics step, the
+// fixed point build replays them and reports how far it ends up from float. Like the trace
+// replay (see TraceRunner.h) it needs LVGL 8.3 with an lv_conf.h and an Arduino.h providing
+// micros() to link, nothing is drawn. Build and run on a PC:
+//
+//   g++ -std=gnu++11 -O2 -I. -I<lvgl> -I<Arduino.h> -o q16_float FixedPointBench.cpp $MAZE_SOURCES <LVGL library>
+//   g++ -std=gnu++11 -O2 -DMAZE_FIXED_POINT=1 -I. -I<lvgl> -I<Arduino.h> -o q16_fixed FixedPointBench.cpp $MAZE_SOURCES <LVGL library>
+//   ./q16_float record steps.bin
+//   ./q16_fixed compare steps.bin
+//
+// with MAZE_SOURCES as in FixedMazeBench.cpp. Both runs roll a ball through the same mazes with
+// the same scripted tilt. For every recorded step the fixed build starts from the float state
+// and takes that one step (the error of a single step), and a second ball runs free from the
+// spawn (how the errors add up).
+
+#ifndef ARDUINO
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+#include "FixedMaze.h"
+
+static const uint32_t SEED = 77;
+static const int STEPS = 240 * 100;  // 100 s at 240 Hz per maze
+static const int TILT_EVERY = 120;   // steps between tilt changes
+
+/**
+ * @brief One physics step of the float build: state and tilt before it, state after it
+ */
+struct Step {
+    float x, y, vx, vy;
+    float roll, pitch;
+    float next_x, next_y, next_vx, next_vy;
+};
+
+struct BenchMaze {
+    const char* name;
+    Maze* maze;
+};
+
+/**
+ * @brief The mazes both builds run, the shipping sizes with fixed and with runtime geometry,
+ * plus an adaptive circle
+ */
+static int buildMazes(BenchMaze* out) {
+    int n = 0;
+    out[n++] = { "rect fixed", new ShippingRectangularMaze() };
+    out[n++] = { "rect", new RectangularMaze(10, 10, 16, 40) };
+    out[n++] = { "circ fixed", new ShippingCircularMaze() };
+    out[n++] = { "circ", new CircularMaze(10, 16, 11) };
+    out[n++] = { "circ adaptive", new CircularMaze(10, 8, 11, /*adaptive=*/true) };
+    for (int i = 0; i < n; ++i) {
+        out[i].maze->setSeed(SEED);
+        out[i].maze->generate();
+    }
+    return n;
+}
+
+
+static void step(Maze& maze, Ball& ball, float roll, float pitch) {
+    ball.updatePhysics(roll, pitch);
+    maze.stepBallWithCollisions(ball, ball.getRadius() * 0.5f, 24);
+}
+
+
+static int record(const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        printf("can't write %s\n", path);
+        return 1;
+    }
+    BenchMaze mazes[8];
+    const int count = buildMazes(mazes);
+    for (int m = 0; m < count; ++m) {
+        Maze& maze = *mazes[m].maze;
+        const lv_point_t spawn = maze.getBallSpawnPixel();
+        Ball ball(nullptr, spawn.x, spawn.y, 5.0f);
+        MazeRandom tilt(SEED);
+        float roll = 0.0f, pitch = 0.0f;
+        for (int i = 0; i < STEPS; ++i) {
+            if (i % TILT_EVERY == 0) {
+                roll = tilt.below(6001) / 100.0f - 30.0f;
+                pitch = tilt.below(6001) / 100.0f - 30.0f;
+            }
+            Step s;
+            s.x = ball.getX(); s.y = ball.getY();
+            s.vx = ball.getVelocityX(); s.vy = ball.getVelocityY();
+            s.roll = roll; s.pitch = pitch;
+            step(maze, ball, roll, pitch);
+            s.next_x = ball.getX(); s.next_y = ball.getY();
+            s.next_vx = ball.getVelocityX(); s.next_vy = ball.getVelocityY();
+            fwrite(&s, sizeof(s), 1, f);
+        }
+    }
+    fclose(f);
+    printf("recorded %d mazes x %d steps\n", count, STEPS);
+    return 0;
+}
+
+
+/**
+ * @brief Mean, 99th percentile and largest value, sorts v
+ */
+static void spread(std::vector<float>& v, float& mean, float& p99, float& max) {
+    std::sort(v.begin(), v.end());
+    double sum = 0.0;
+    for (float e : v) sum += e;
+    mean = (float)(sum / v.size());
+    p99 = v[v.size() * 99 / 100];
+    max = v.back();
+}
+
+
+static int compare(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        printf("can't read %s\n", path);
+        return 1;
+    }
+    BenchMaze mazes[8];
+    const int count = buildMazes(mazes);
+    printf("%-14s %27s %19s %24s\n", "", "one step position error px", "velocity error", "free run distance px");
+    printf("%-14s %9s %8s %8s %10s %8s %7s %7s %8s\n", "maze", "mean", "p99", "max", "p99", "max", "1 s", "10 s", "100 s");
+
+    std::vector<float> pos_err(STEPS), vel_err(STEPS);
+    for (int m = 0; m < count; ++m) {
+        Maze& maze = *mazes[m].maze;
+        const lv_point_t spawn = maze.getBallSpawnPixel();
+        Ball ball(nullptr, spawn.x, spawn.y, 5.0f);
+        Ball free_run(nullptr, spawn.x, spawn.y, 5.0f);
+        float drift_1s = 0.0f, drift_10s = 0.0f, drift = 0.0f;
+        for (int i = 0; i < STEPS; ++i) {
+            Step s;
+            if (fread(&s, sizeof(s), 1, f) != 1) {
+                printf("%s is shorter than this run, recorded with other settings?\n", path);
+                fclose(f);
+                return 1;
+            }
+            ball.setX(s.x); ball.setY(s.y);
+            ball.setVelocityX(s.vx); ball.setVelocityY(s.vy);
+            step(maze, ball, s.roll, s.pitch);
+            pos_err[i] = hypotf(ball.getX() - s.next_x, ball.getY() - s.next_y);
+            vel_err[i] = hypotf(ball.getVelocityX() - s.next_vx, ball.getVelocityY() - s.next_vy);
+
+            step(maze, free_run, s.roll, s.pitch);
+            const float d = hypotf(free_run.getX() - s.next_x, free_run.getY() - s.next_y);
+            if (d > drift) drift = d;
+            if (i < 240) drift_1s = drift;
+            if (i < 2400) drift_10s = drift;
+        }
+        float pos_mean, pos_p99, pos_max, vel_mean, vel_p99, vel_max;
+        spread(pos_err, pos_mean, pos_p99, pos_max);
+        spread(vel_err, vel_mean, vel_p99, vel_max);
+        printf("%-14s %9.1e %8.1e %8.1e %10.1e %8.1e %7.3f %7.2f %8.1f\n", mazes[m].name,
+               pos_mean, pos_p99, pos_max, vel_p99, vel_max, drift_1s, drift_10s, drift);
+    }
+    fclose(f);
+    return 0;
+}
+
+
+int main(int argc, char** argv) {
+    if (argc == 3 && !strcmp(argv[1], "record") && !MAZE_FIXED_POINT) return record(argv[2]);
+    if (argc == 3 && !strcmp(argv[1], "compare") && MAZE_FIXED_POINT) return compare(argv[2]);
+    printf("usage: float build: %s record <file>, MAZE_FIXED_POINT=1 build: %s compare <file>\n", argv[0], argv[0]);
+    return 2;
+}
+
+#endif // ARDUINO
@@ -0,0 +1,24 @@
+#include "FlushMonitor.h"
+
+FlushMonitor* FlushMonitor::active = nullptr;
+void (*FlushMonitor::driver_flush)(lv_disp_drv_t*, const lv_area_t*, lv_color_t*) = nullptr;
+
+
+void FlushMonitor::attach(lv_disp_t* disp) {
+    if (!disp || !disp->driver) return;
+    active = this;
+    // don't wrap our own wrapper if attached twice
+    if (disp->driver->flush_cb == countingFlush) return;
+    driver_flush = disp->driver->flush_cb;
+    disp->driver->flush_cb = countingFlush;
+}
+
+
+void FlushMonitor::countingFlush(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* color_p) {
+    if (active) {
+        ++active->flush_count;
+        active->flushed_px += (uint32_t)lv_area_get_width(area) * lv_area_get_height(area);
+        if (lv_disp_flush_is_last(drv)) ++active->refresh_count;
+    }
+    driver_flush(drv, area, color_p);
+}
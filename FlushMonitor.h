@@ -0,0 +1,39 @@
+#ifndef FLUSH_MONITOR_H
+#define FLUSH_MONITOR_H
+
+#include <lvgl.h>
+#include <stdint.h>
+
+/**
+ * @class FlushMonitor
+ * @brief Counts what the display driver actually sends to the panel, by wrapping its flush callback.
+ *
+ * A flush is one area handed to the driver (a refresh can take several, the draw buffer only
+ * holds 10 lines), a refresh ends with the last flush of a frame. Frames where nothing was
+ * invalidated don't flush at all. Only one display can be watched, the flush callback gets
+ * no user data.
+ */
+class FlushMonitor {
+public:
+    /**
+     * @brief Starts counting, call after the display driver is registered
+     */
+    void attach(lv_disp_t* disp);
+
+    uint32_t flushes() const { return flush_count; }
+    uint32_t refreshes() const { return refresh_count; }
+    uint32_t pixels() const { return flushed_px; }
+
+    void reset() { flush_count = 0; refresh_count = 0; flushed_px = 0; }
+
+private:
+    uint32_t flush_count = 0;
+    uint32_t refresh_count = 0;
+    uint32_t flushed_px = 0;
+
+    static FlushMonitor* active;
+    static void (*driver_flush)(lv_disp_drv_t*, const lv_area_t*, lv_color_t*);
+    static void countingFlush(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* color_p);
+};
+
+#endif // FLUSH_MONITOR_H
@@ -0,0 +1,41 @@
+#include "FrameTimer.h"
+#include <Arduino.h>
+
+void FrameTimer::tick() {
+    const uint32_t now = micros();
+    if (!started) {
+        started = true;
+        last_tick_us = now;
+        return;
+    }
+    const uint32_t dt = now - last_tick_us;
+    last_tick_us = now;
+
+    history[history_idx] = dt;
+    history_idx = (history_idx + 1) % WINDOW;
+
+    if (frames_after < 0) return;
+
+    if (frames_after == 0) {
+        event_us = dt;
+    } else if (dt > after_us) {
+        after_us = dt;
+    }
+
+    if (++frames_after > WINDOW) {
+        frames_after = -1;
+        last_worst_us = max(before_us, max(event_us, after_us));
+        if (callback) callback(before_us, event_us, after_us, callback_data);
+    }
+}
+
+
+void FrameTimer::markEvent() {
+    before_us = 0;
+    for (int i = 0; i < WINDOW; ++i) {
+        if (history[i] > before_us) before_us = history[i];
+    }
+    event_us = 0;
+    after_us = 0;
+    frames_after = 0;
+}
@@ -0,0 +1,57 @@
+#ifndef FRAME_TIMER_H
+#define FRAME_TIMER_H
+
+#include <stdint.h>
+
+/**
+ * @class FrameTimer
+ * @brief Measures loop frame times and reports the worst ones around a marked event (e.g. a level change).
+ */
+class FrameTimer {
+public:
+    static constexpr int WINDOW = 8; ///< frames looked at on each side of the event
+
+    /**
+     * @brief Receives the measurements WINDOW frames after an event
+     * @param worst_before_us longest of the WINDOW frames before the event
+     * @param event_us length of the frame the event happened in
+     * @param worst_after_us longest of the WINDOW frames after the event
+     */
+    typedef void (*ReportCallback)(uint32_t worst_before_us, uint32_t event_us,
+                                   uint32_t worst_after_us, void* user_data);
+
+    void setReportCallback(ReportCallback cb, void* user_data) { callback = cb; callback_data = user_data; }
+
+    /**
+     * @brief Call once at the top of every loop iteration
+     */
+    void tick();
+
+    /**
+     * @brief Marks that the event happens in the current frame
+     */
+    void markEvent();
+
+    /**
+     * @brief Worst frame of the last complete report (before, event or after)
+     */
+    uint32_t lastWorstUs() const { return last_worst_us; }
+
+private:
+    uint32_t history[WINDOW] = {0};
+    uint8_t history_idx = 0;
+    uint32_t last_tick_us = 0;
+    bool started = false;
+
+    // pending report
+    int8_t frames_after = -1;  ///< -1: no event pending, 0: event frame not closed yet
+    uint32_t before_us = 0;
+    uint32_t event_us = 0;
+    uint32_t after_us = 0;
+    uint32_t last_worst_us = 0;
+
+    ReportCallback callback = nullptr;
+    void* callback_data = nullptr;
+};
+
+#endif // FRAME_TIMER_H
@@ -0,0 +1,210 @@
+#include "GraphMaze.h"
+#include <Arduino.h>
+#include <math.h>
+
+
+
+void GraphMaze::initTopology(int marker_size) {
+    marker_px = marker_size;
+    const int n = topology.cellCount();
+
+    int slots = 0;
+    border_cells.clear();
+    for (int c = 0; c < n; ++c) {
+        slots += topology.portCount(c);
+        if (topology.onBorder(c)) border_cells.push_back((uint16_t)c);
+    }
+    // shared walls are stored once, so this is an upper bound
+    wall_layer.reserve(slots, 2 * slots);
+    analyzer.reserve(n);
+}
+
+
+void GraphMaze::beginGenerate() {
+    rng.setSeed(seed);
+    topology.raiseAllWalls();
+    placeExitAndSpawn();
+    generator.begin(topology, rng.below(topology.cellCount()), rng);
+}
+
+
+void GraphMaze::placeExitAndSpawn() {
+    setExitCell(border_cells[rng.below(border_cells.size())]);
+
+    // Spawn on the border as far from the exit as possible (ties go to the lowest index)
+    float best = -1.0f;
+    for (size_t i = 0; i < border_cells.size(); ++i) {
+        lv_point_t p = cellCenterPixel(border_cells[i]);
+        float dx = p.x - exit_px.x, dy = p.y - exit_px.y;
+        float d = dx*dx + dy*dy;
+        if (d > best) { best = d; spawn_cell = border_cells[i]; }
+    }
+    ball_spawn_px = cellCenterPixel(spawn_cell);
+    last_cell = spawn_cell;
+}
+
+
+void GraphMaze::setExitCell(int cell) {
+    exit_cell = cell;
+    exit_px = cellCenterPixel(cell);
+}
+
+
+void GraphMaze::finishGenerate() {
+    analyzer.run(topology, spawn_cell, exit_cell);
+    if (exit_placement != ExitPlacement::Farthest) return;
+
+    int best = exit_cell;
+    uint16_t best_d = 0;
+    for (size_t i = 0; i < border_cells.size(); ++i) {
+        uint16_t d = analyzer.distance(border_cells[i]);
+        if (d != MazeAnalyzer::UNREACHED && d > best_d) { best_d = d; best = border_cells[i]; }
+    }
+    setExitCell(best);
+    analyzer.setTarget(best);
+}
+
+
+void GraphMaze::beginDraw(lv_obj_t* parent) {
+    lv_obj_clean(parent);
+    draw_parent = parent;
+    draw_cursor = 0;
+    wall_layer.begin(parent);
+}
+
+
+bool GraphMaze::drawStep(uint32_t max_walls) {
+    // Every (cell, port) slot, a shared wall is drawn from its lower cell only
+    const int total_slots = topology.cellCount() * MazeTopology::MAX_PORTS;
+
+    while (draw_cursor < total_slots && max_walls > 0) {
+        int k = draw_cursor++;
+        int cell = k / MazeTopology::MAX_PORTS, port = k % MazeTopology::MAX_PORTS;
+        if (port >= topology.portCount(cell) || !(topology.walls(cell) & (1u << port))) continue;
+        int other = topology.neighborAt(cell, port);
+        if (other >= 0 && other < cell) continue;
+
+        float x0, y0, x1, y1;
+        wallSegment(cell, port, x0, y0, x1, y1);
+        wall_layer.addLine({ (lv_coord_t)lroundf(x0), (lv_coord_t)lroundf(y0) },
+                           { (lv_coord_t)lroundf(x1), (lv_coord_t)lroundf(y1) });
+        --max_walls;
+    }
+    wall_layer.flush();
+    if (draw_cursor < total_slots) return false;
+
+    if (draw_cursor == total_slots) {
+        // Draw exit (red)
+        lv_obj_t* exitObj = lv_obj_create(draw_parent);
+        lv_obj_set_size(exitObj, marker_px, marker_px);
+        lv_obj_set_pos(exitObj, exit_px.x - marker_px/2, exit_px.y - marker_px/2);
+        lv_obj_set_style_bg_color(exitObj, lv_color_make(255, 0, 0), 0);
+        lv_obj_set_style_border_width(exitObj, 0, 0);
+        lv_obj_set_style_radius(exitObj, 0, 0);
+        draw_cursor++;
+    }
+    return true;
+}
+
+
+bool GraphMaze::collideCell(int cell, float& x, float& y, float& vx, float& vy, float br) const {
+    const uint8_t walls = topology.walls(cell);
+    bool touched = false;
+
+    for (int port = 0; port < topology.portCount(cell); ++port) {
+        if (!(walls & (1u << port))) continue;
+        float x0, y0, x1, y1;
+        wallSegment(cell, port, x0, y0, x1, y1);
+
+        // closest point on the wall to the ball center
+        float cx = x, cy = y;
+        float ex = x1 - x0, ey = y1 - y0;
+        float len2 = ex*ex + ey*ey;
+        float t = len2 > 0.0f ? ((cx - x0)*ex + (cy - y0)*ey) / len2 : 0.0f;
+        if (t < 0.0f) t = 0.0f;
+        if (t > 1.0f) t = 1.0f;
+        float dx = cx - (x0 + t*ex);
+        float dy = cy - (y0 + t*ey);
+        float d2 = dx*dx + dy*dy;
+        if (d2 >= br*br) continue;
+
+        // push out along the contact normal, fall back to the wall normal when centered on it
+        float d = sqrtf(d2);
+        float nx, ny;
+        if (d > 1e-4f) { nx = dx / d; ny = dy / d; }
+        else { float l = sqrtf(len2); nx = -ey / l; ny = ex / l; d = 0.0f; }
+        x = cx + nx * (br - d);
+        y = cy + ny * (br - d);
+        touched = true;
+        reflectOffWall(vx, vy, nx, ny);
+    }
+    return touched;
+}
+
+
+void GraphMaze::sweepCell(int cell, const Sweep& s, SweepHit& hit) const {
+    const uint8_t walls = topology.walls(cell);
+    for (int port = 0; port < topology.portCount(cell); ++port) {
+        if (!(walls & (1u << port))) continue;
+        float x0, y0, x1, y1;
+        wallSegment(cell, port, x0, y0, x1, y1);
+        sweepSegment(s, x0, y0, x1, y1, hit);
+    }
+}
+
+
+void GraphMaze::sweepWalls(const Sweep& s, SweepHit& hit) {
+    int from = cellAtPixel(s.px, s.py);
+    if (from < 0) from = last_cell;
+    last_cell = from;
+    int to = cellAtPixel(s.px + s.dx, s.py + s.dy);
+
+    // a physics step moves less than a cell, the cells around both ends hold every wall in reach
+    int nb[MazeGrid::MAX_NEIGHBORS];
+    sweepCell(from, s, hit);
+    int k = topology.neighbors(from, nb);
+    for (int i = 0; i < k; ++i) sweepCell(nb[i], s, hit);
+    if (to < 0 || to == from) return;
+    sweepCell(to, s, hit);
+    k = topology.neighbors(to, nb);
+    for (int i = 0; i < k; ++i) sweepCell(nb[i], s, hit);
+}
+
+
+void GraphMaze::handleCollisions(Ball& ball) {
+    if (const WallDistanceField* field = fieldFor(collision_mode)) field->collide(ball);
+    else collideAround(ball);
+}
+
+
+bool GraphMaze::collideAround(float& x, float& y, float& vx, float& vy, float br) {
+    int cell = cellAtPixel(x, y);
+    if (cell < 0) cell = last_cell;
+    last_cell = cell;
+
+    // the ball can touch walls of the cells around it near corners
+    bool touched = collideCell(cell, x, y, vx, vy, br);
+    int nb[MazeGrid::MAX_NEIGHBORS];
+    int k = topology.neighbors(cell, nb);
+    for (int i = 0; i < k; ++i) touched |= collideCell(nb[i], x, y, vx, vy, br);
+    return touched;
+}
+
+
+void GraphMaze::stepBallWithCollisions(Ball& ball,
+                                       float max_step_px,
+                                       uint8_t max_substeps) {
+    if (const WallDistanceField* field = fieldFor(collision_mode)) stepFieldBody(ball, *field, max_step_px, max_substeps);
+    else stepBody(ball, max_step_px, max_substeps);
+}
+
+
+void GraphMaze::stepSwarmWithCollisions(BallSwarm& swarm,
+                                        float max_step_px,
+                                        uint8_t max_substeps) {
+    const WallDistanceField* field = fieldFor(collision_mode);
+    swarm.forEachBody([&](BallSwarm::Body& b) {
+        if (field) stepFieldBody(b, *field, max_step_px, max_substeps);
+        else stepBody(b, max_step_px, max_substeps);
+    });
+}
@@ -0,0 +1,139 @@
+#ifndef GRAPH_MAZE_H
+#define GRAPH_MAZE_H
+
+#include "maze.h"
+#include "MazeTopology.h"
+#include <vector>
+#include <array>
+#include "Ball.h"
+#include "BallSwarm.h"
+#include "SweptCollision.h"
+
+/**
+ * @class GraphMaze
+ * @brief Maze on any cell graph. The topology is a MazeTopology (CSR adjacency plus wall
+ * masks), the subclass is the geometry provider: cell positions and wall segments.
+ *
+ * Generation, analysis, exit placement, drawing and collision are shared, so a new grid
+ * shape only has to fill in the topology and describe where its walls are.
+ */
+class GraphMaze : public Maze {
+public:
+    virtual void beginGenerate() override;
+    virtual void beginDraw(lv_obj_t* parent) override;
+    virtual bool drawStep(uint32_t max_walls) override;
+
+    /**
+     * @brief Pushes the ball out of every raised wall of its cell and the cells around it
+     */
+    virtual void handleCollisions(Ball& ball) override;
+    virtual void stepBallWithCollisions(Ball& ball,
+                                    float max_step_px = -1.0f,
+                                    uint8_t max_substeps = 32) override;
+    virtual void stepSwarmWithCollisions(BallSwarm& swarm,
+                                    float max_step_px = -1.0f,
+                                    uint8_t max_substeps = 32) override;
+
+    lv_point_t getBallSpawnPixel() const override { return ball_spawn_px; }
+    lv_point_t getExitPixel() const override { return exit_px; }
+    int exitCell() const override { return exit_cell; }
+
+protected:
+    GraphMaze() {}
+
+    /**
+     * @brief Sizes the buffers, called by the subclass constructor once topology is filled in
+     * @param marker_size edge of the exit marker in px
+     */
+    void initTopology(int marker_size);
+
+    /**
+     * @brief Endpoints of the wall behind port of cell, in screen pixels
+     */
+    virtual void wallSegment(int cell, int port, float& x0, float& y0, float& x1, float& y1) const = 0;
+
+    /**
+     * @brief BFS from the spawn for the stats, then moves the exit to the farthest border cell if requested
+     */
+    virtual void finishGenerate() override;
+
+    const MazeGrid& grid() const override { return topology; }
+
+    MazeTopology topology;
+
+private:
+    std::vector<uint16_t> border_cells; ///< cells with at least one border wall, exit and spawn candidates
+    int exit_cell = 0;
+    int spawn_cell = 0;
+    int last_cell = 0; ///< cell used when the ball is (briefly) outside every cell
+    int marker_px = 4;
+    lv_point_t exit_px = {0,0};
+    lv_point_t ball_spawn_px = {120,120};
+
+    // Incremental drawing state
+    lv_obj_t* draw_parent = nullptr;
+    int draw_cursor = 0; ///< cell * MazeTopology::MAX_PORTS + port
+
+    /**
+     * @brief Picks a random border cell as exit and the border cell farthest away from it as spawn
+     */
+    void placeExitAndSpawn();
+
+    void setExitCell(int cell);
+
+    /**
+     * @brief One ball's move with the selected collision mode
+     * @param ball a Ball or a BallSwarm::Body
+     */
+    template <typename Body>
+    void stepBody(Body& ball, float max_step_px, uint8_t max_substeps);
+
+    /**
+     * @brief handleCollisions for a Ball or a BallSwarm::Body
+     */
+    template <typename Body>
+    void collideAround(Body& ball);
+
+    /**
+     * @brief Resolves a ball (position, velocity, radius) against the walls of its cell and
+     * the cells around it, returns true if anything changed
+     */
+    bool collideAround(float& x, float& y, float& vx, float& vy, float br);
+
+    /**
+     * @brief Resolves the ball against the raised walls of one cell
+     */
+    bool collideCell(int cell, float& x, float& y, float& vx, float& vy, float br) const;
+
+    /**
+     * @brief Earliest contact of a move with the walls of cell
+     */
+    void sweepCell(int cell, const Sweep& s, SweepHit& hit) const;
+
+    /**
+     * @brief Earliest contact of a move with the walls around its start and end cells
+     */
+    void sweepWalls(const Sweep& s, SweepHit& hit);
+};
+
+
+template <typename Body>
+void GraphMaze::stepBody(Body& ball, float max_step_px, uint8_t max_substeps) {
+    if (collision_mode == CollisionMode::Swept) {
+        stepBallSwept(ball, [this](const Sweep& s, SweepHit& hit) { sweepWalls(s, hit); });
+        return;
+    }
+    stepBallInSubsteps(ball, max_step_px, max_substeps, [this](Body& b) {
+        collideAround(b);
+    });
+}
+
+
+template <typename Body>
+void GraphMaze::collideAround(Body& ball) {
+    collideBody(ball, [this](float& x, float& y, float& vx, float& vy, float br) {
+        return collideAround(x, y, vx, vy, br);
+    });
+}
+
+#endif // GRAPH_MAZE_H
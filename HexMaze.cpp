@@ -0,0 +1,100 @@
+#include "HexMaze.h"
+#include <math.h>
+
+static constexpr float SQRT3 = 1.7320508f;
+
+
+HexMaze::HexMaze(int cols, int rows, int size) {
+    COLS = cols;
+    ROWS = rows;
+    SIZE = size;
+
+    // center the grid on the 240 x 240 screen
+    const float width = SQRT3 * SIZE * (COLS + 0.5f);
+    const float height = SIZE * (1.5f * (ROWS - 1) + 2.0f);
+    origin_x = 120.0f - width / 2 + SQRT3 / 2 * SIZE;
+    origin_y = 120.0f - height / 2 + SIZE;
+
+    // corner i sits at -30 + 60 * i degrees (y points down, so this goes clockwise from upper right)
+    for (int i = 0; i < 7; ++i) {
+        float a = (60.0f * i - 30.0f) * (float)M_PI / 180.0f;
+        corner_x[i] = SIZE * cosf(a);
+        corner_y[i] = SIZE * sinf(a);
+    }
+
+    topology.clear(COLS * ROWS, COLS * ROWS * 6);
+    for (int r = 0; r < ROWS; ++r) {
+        topology.beginRow();
+        // odd rows are shifted right, so their diagonal neighbours are one column further right
+        const int shift = r & 1;
+        for (int c = 0; c < COLS; ++c) {
+            const int cell = r * COLS + c;
+            topology.addCell(6);
+            const int dl = c - 1 + shift; // column of the lower / upper left neighbour
+            const int dr = c + shift;     // column of the lower / upper right neighbour
+            if (c + 1 < COLS) topology.addNeighbor(cell + 1, HEX_E);
+            if (r + 1 < ROWS && dr < COLS) topology.addNeighbor((r + 1) * COLS + dr, HEX_SE);
+            if (r + 1 < ROWS && dl >= 0)   topology.addNeighbor((r + 1) * COLS + dl, HEX_SW);
+            if (c > 0) topology.addNeighbor(cell - 1, HEX_W);
+            // north for row based algorithms: upper right, or upper left on the right edge
+            if (r > 0 && dl >= 0)   topology.addNeighbor((r - 1) * COLS + dl, HEX_NW, dr >= COLS);
+            if (r > 0 && dr < COLS) topology.addNeighbor((r - 1) * COLS + dr, HEX_NE, true);
+        }
+    }
+    initTopology(SIZE);
+}
+
+
+MazeId HexMaze::getId() const {
+    MazeId id;
+    id.type = MazeType::Hex;
+    id.algorithm = getAlgorithm();
+    id.dims[0] = COLS;
+    id.dims[1] = ROWS;
+    id.dims[2] = SIZE;
+    id.seed = seed;
+    id.exit_placement = exit_placement;
+    return id;
+}
+
+
+void HexMaze::centerOf(int cell, float& x, float& y) const {
+    int r = cell / COLS, c = cell % COLS;
+    x = origin_x + SQRT3 * SIZE * (c + 0.5f * (r & 1));
+    y = origin_y + 1.5f * SIZE * r;
+}
+
+
+lv_point_t HexMaze::cellCenterPixel(int cell) const {
+    float x, y;
+    centerOf(cell, x, y);
+    return { (lv_coord_t)lroundf(x), (lv_coord_t)lroundf(y) };
+}
+
+
+int HexMaze::cellAtPixel(float x, float y) const {
+    // the nearest center is the hexagon the point is in, check the 3 x 3 candidates around the estimate
+    const int r0 = (int)lroundf((y - origin_y) / (1.5f * SIZE));
+    int best = -1;
+    float best_d = SIZE * SIZE; // outside every circumcircle counts as outside the maze
+    for (int r = r0 - 1; r <= r0 + 1; ++r) {
+        if (r < 0 || r >= ROWS) continue;
+        const int c0 = (int)lroundf((x - origin_x) / (SQRT3 * SIZE) - 0.5f * (r & 1));
+        for (int c = c0 - 1; c <= c0 + 1; ++c) {
+            if (c < 0 || c >= COLS) continue;
+            float cx, cy;
+            centerOf(r * COLS + c, cx, cy);
+            float d = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+            if (d < best_d) { best_d = d; best = r * COLS + c; }
+        }
+    }
+    return best;
+}
+
+
+void HexMaze::wallSegment(int cell, int port, float& x0, float& y0, float& x1, float& y1) const {
+    float cx, cy;
+    centerOf(cell, cx, cy);
+    x0 = cx + corner_x[port];     y0 = cy + corner_y[port];
+    x1 = cx + corner_x[port + 1]; y1 = cy + corner_y[port + 1];
+}
@@ -0,0 +1,40 @@
+#ifndef HEX_MAZE_H
+#define HEX_MAZE_H
+
+#include "GraphMaze.h"
+
+/**
+ * @class HexMaze
+ * @brief Maze of pointy top hexagons, odd rows shifted right by half a cell, centered on screen.
+ */
+class HexMaze : public GraphMaze {
+public:
+    /**
+     * @param cols hexagons per row
+     * @param rows number of rows
+     * @param size hexagon circumradius in pixels
+     */
+    HexMaze(int cols, int rows, int size);
+
+    virtual MazeId getId() const override;
+
+    int cellAtPixel(float x, float y) const override;
+    lv_point_t cellCenterPixel(int cell) const override;
+
+protected:
+    void wallSegment(int cell, int port, float& x0, float& y0, float& x1, float& y1) const override;
+
+private:
+    // Ports in clockwise order, wall p runs from corner p to corner p + 1
+    enum HexPort : uint8_t { HEX_E, HEX_SE, HEX_SW, HEX_W, HEX_NW, HEX_NE };
+
+    int COLS;
+    int ROWS;
+    int SIZE;
+    float origin_x, origin_y; ///< center of cell 0
+    float corner_x[7], corner_y[7]; ///< corner offsets from the cell center, corner 6 == corner 0
+
+    void centerOf(int cell, float& x, float& y) const;
+};
+
+#endif // HEX_MAZE_H
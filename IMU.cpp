@@ -1,21 +1,43 @@
 #include "IMU.h"
+#include <math.h>
+#ifdef ARDUINO
 #include <Arduino.h>
+#endif
+
+// float constant, 180.0 / PI made every angle a double conversion
+static constexpr float RAD_TO_DEGREES = 57.2957795f;
 
 IMU::IMU(float threshold, int samples)
-    : myIMU(I2C_MODE, 0x6A),
+    :
+#if defined(ARDUINO) && IMU_FIFO
+      live(wire),
+#endif
       turnThreshold(threshold),
       numSamples(samples),
       samplesRead(samples),
       rollAvg(0.0f),
-      pitchAvg(0.0f) {}
+      pitchAvg(0.0f) {
+    setSource(nullptr);
+}
+
+void IMU::setSource(ImuSource* s) {
+#ifdef ARDUINO
+    source = s ? s : &live;
+#else
+    source = s;
+#endif
+}
 
 bool IMU::begin() {
-    Wire.begin();
-    if (myIMU.begin() != 0) {
+    if (!source || !source->begin()) {
+#ifdef ARDUINO
         Serial.println("IMU device error");
+#endif
         return false;
     }
+#ifdef ARDUINO
     Serial.println("IMU initialized successfully.");
+#endif
     return true;
 }
 
@@ -25,40 +47,43 @@ void IMU::getRollAndPitch(float& roll, float& pitch) const {
 }
 
 bool IMU::read() {
-    float gX = myIMU.readFloatGyroX();
-    float gY = myIMU.readFloatGyroY();
-    float gZ = myIMU.readFloatGyroZ();
+    if (!source) return false;
+    float gX, gY, gZ;
+    source->readGyro(gX, gY, gZ);
 
-    if (fabs(gX) + fabs(gY) + fabs(gZ) < turnThreshold) {
+    if (fabsf(gX) + fabsf(gY) + fabsf(gZ) < turnThreshold) {
         return false; // No significant motion
     }
 
     // Motion detected, take samples
-    float rollSum = 0;
-    float pitchSum = 0;
+    float rollSum = 0.0f;
+    float pitchSum = 0.0f;
 
-    for (int i = 0; i < numSamples; ++i) {
-        float aX = myIMU.readFloatAccelX();
-        float aY = myIMU.readFloatAccelY();
-        float aZ = myIMU.readFloatAccelZ();
+    int n = 0;
+    for (; n < numSamples; ++n) {
+        float aX, aY, aZ;
+        if (!source->readAccel(aX, aY, aZ)) break;
 
-        float pitchAcc = atan2(-aX, sqrt(aY * aY + aZ * aZ)) * 180.0 / PI;
-        float rawRoll = atan2(aY, aZ) * 180.0 / PI;
+        float pitchAcc = atan2f(-aX, sqrtf(aY * aY + aZ * aZ)) * RAD_TO_DEGREES;
+        float rawRoll = atan2f(aY, aZ) * RAD_TO_DEGREES;
 
         // Clamp roll to –90 to +90
-        float rollAcc = (rawRoll > 90)  ? rawRoll - 180 :
-                        (rawRoll < -90) ? rawRoll + 180 :
-                                          rawRoll;
+        float rollAcc = (rawRoll > 90.0f)  ? rawRoll - 180.0f :
+                        (rawRoll < -90.0f) ? rawRoll + 180.0f :
+                                             rawRoll;
         
         rollSum += rollAcc;
         pitchSum += pitchAcc;
     }
 
-    rollAvg = rollSum / numSamples;
-    pitchAvg = pitchSum / numSamples;
+    if (n == 0) return false;
+    rollAvg = rollSum / n;
+    pitchAvg = pitchSum / n;
     
+#ifdef ARDUINO
     Serial.print("Roll: "); Serial.print(rollAvg, 1);
     Serial.print(", Pitch: "); Serial.println(pitchAvg, 1);
+#endif
 
     return true;
 }
\ No newline at end of file
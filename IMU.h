@@ -1,8 +1,14 @@
 #ifndef IMU_H
 #define IMU_H
 
-#include <LSM6DS3.h>
-#include <Wire.h>
+#include "ImuSource.h"
+#include "ImuBus.h"
+#include "FifoImuSource.h"
+
+// 1 reads the sensor's FIFO in bursts (FifoImuSource), 0 register by register through the LSM6DS3 library
+#ifndef IMU_FIFO
+#define IMU_FIFO 1
+#endif
 
 class IMU {
 public:
@@ -14,12 +20,34 @@ public:
     IMU(float threshold = 5.0f, int samples = 10);
 
     /**
-     * @brief Initializes Wire for IMU, returns true if IMU started successfully.
+     * @brief Takes readings from source instead of the sensor, e.g. a RecordingImuSource around
+     * sensor() or a ReplayImuSource. nullptr goes back to the sensor (none off the board).
+     */
+    void setSource(ImuSource* s);
+
+#ifdef ARDUINO
+    ImuSource& sensor() { return live; }
+
+    /**
+     * @brief The I2C traffic of the FIFO source, nullptr when IMU_FIFO is 0
+     */
+    ImuBus* bus() {
+#if IMU_FIFO
+        return &wire;
+#else
+        return nullptr;
+#endif
+    }
+#endif
+
+    /**
+     * @brief Initializes the source (Wire and the sensor by default), returns true if it started successfully.
      */
     bool begin();
 
     /**
-     * @brief If gyro readings rises above threshold, reads and averages samples amount of accelerometer data and return true.
+     * @brief If gyro readings rises above threshold, reads and averages up to samples amount of accelerometer data and return true.
+     * Stops early when the source has no more (a FIFO batch used up), false if it had none.
      */
     bool read();
 
@@ -29,7 +57,15 @@ public:
     void getRollAndPitch(float& roll, float& pitch) const;
 
 private:
-    LSM6DS3 myIMU;
+#ifdef ARDUINO
+#if IMU_FIFO
+    WireImuBus wire;
+    FifoImuSource live;
+#else
+    LiveImuSource live;
+#endif
+#endif
+    ImuSource* source;
     const float turnThreshold;
     const int numSamples;
     int samplesRead;
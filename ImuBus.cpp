@@ -0,0 +1,28 @@
+#include "ImuBus.h"
+
+#ifdef ARDUINO
+#include <Wire.h>
+
+bool WireImuBus::begin() {
+    Wire.begin();
+    return true;
+}
+
+
+bool WireImuBus::transferRead(uint8_t reg, uint8_t* buf, size_t len) {
+    Wire.beginTransmission(address);
+    Wire.write(reg);
+    if (Wire.endTransmission(false) != 0) return false;
+    if (Wire.requestFrom(address, (uint8_t)len) != len) return false;
+    for (size_t i = 0; i < len; ++i) buf[i] = Wire.read();
+    return true;
+}
+
+
+bool WireImuBus::transferWrite(uint8_t reg, uint8_t value) {
+    Wire.beginTransmission(address);
+    Wire.write(reg);
+    Wire.write(value);
+    return Wire.endTransmission() == 0;
+}
+#endif
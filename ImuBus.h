@@ -0,0 +1,83 @@
+#ifndef IMU_BUS_H
+#define IMU_BUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Most bytes one I2C read may return. The SAMD21 Wire buffer holds 32, the other XIAO cores more.
+#ifndef IMU_I2C_BURST_BYTES
+#define IMU_I2C_BURST_BYTES 24
+#endif
+
+/**
+ * @class ImuBus
+ * @brief Register access to the IMU, one call is one bus transaction.
+ *
+ * Counts transactions and the data bytes they move (register addresses not included), so
+ * the cost of a way of reading the sensor can be compared on the board and on a mock.
+ */
+class ImuBus {
+public:
+    virtual ~ImuBus() {}
+
+    /**
+     * @brief Starts the bus, returns true if it's ready
+     */
+    virtual bool begin() { return true; }
+
+    /**
+     * @brief Reads len consecutive registers from reg on in one transaction, len <= maxRead()
+     * @return false if the device didn't answer
+     */
+    bool readRegisters(uint8_t reg, uint8_t* buf, size_t len) {
+        ++transaction_count;
+        byte_count += len;
+        return transferRead(reg, buf, len);
+    }
+
+    bool writeRegister(uint8_t reg, uint8_t value) {
+        ++transaction_count;
+        ++byte_count;
+        return transferWrite(reg, value);
+    }
+
+    /**
+     * @brief Most bytes one readRegisters() may ask for
+     */
+    virtual size_t maxRead() const { return IMU_I2C_BURST_BYTES; }
+
+    // Counters since the last resetStats()
+    uint32_t transactions() const { return transaction_count; }
+    uint32_t bytes() const { return byte_count; }
+    void resetStats() { transaction_count = byte_count = 0; }
+
+protected:
+    virtual bool transferRead(uint8_t reg, uint8_t* buf, size_t len) = 0;
+    virtual bool transferWrite(uint8_t reg, uint8_t value) = 0;
+
+private:
+    uint32_t transaction_count = 0;
+    uint32_t byte_count = 0;
+};
+
+#ifdef ARDUINO
+/**
+ * @class WireImuBus
+ * @brief The IMU on Wire: register address written, then a repeated start read
+ */
+class WireImuBus : public ImuBus {
+public:
+    explicit WireImuBus(uint8_t address = 0x6A) : address(address) {}
+
+    bool begin() override;
+
+protected:
+    bool transferRead(uint8_t reg, uint8_t* buf, size_t len) override;
+    bool transferWrite(uint8_t reg, uint8_t value) override;
+
+private:
+    uint8_t address;
+};
+#endif
+
+#endif // IMU_BUS_H
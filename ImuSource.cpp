@@ -0,0 +1,68 @@
+#include "ImuSource.h"
+
+#ifdef ARDUINO
+#include <Wire.h>
+
+bool LiveImuSource::begin() {
+    Wire.begin();
+    return sensor.begin() == 0;
+}
+
+
+void LiveImuSource::readGyro(float& x, float& y, float& z) {
+    x = sensor.readFloatGyroX();
+    y = sensor.readFloatGyroY();
+    z = sensor.readFloatGyroZ();
+}
+
+
+bool LiveImuSource::readAccel(float& x, float& y, float& z) {
+    x = sensor.readFloatAccelX();
+    y = sensor.readFloatAccelY();
+    z = sensor.readFloatAccelZ();
+    return true;
+}
+#endif
+
+
+void RecordingImuSource::readGyro(float& x, float& y, float& z) {
+    from.readGyro(x, y, z);
+    to.reading(TraceRecord::GYRO, SessionClock::liveMicros(), x, y, z);
+}
+
+
+bool RecordingImuSource::readAccel(float& x, float& y, float& z) {
+    if (!from.readAccel(x, y, z)) return false;
+    to.reading(TraceRecord::ACCEL, SessionClock::liveMicros(), x, y, z);
+    return true;
+}
+
+
+bool ReplayImuSource::readAccel(float& x, float& y, float& z) {
+    TraceRecord r;
+    if (!from.peek(r) || r.kind != TraceRecord::ACCEL) {
+        // the recorded source had no more this frame
+        x = y = z = 0.0f;
+        return false;
+    }
+    from.next(r);
+    x = r.v[0];
+    y = r.v[1];
+    z = r.v[2];
+    return true;
+}
+
+
+void ReplayImuSource::take(char kind, float& x, float& y, float& z) {
+    TraceRecord r;
+    if (!from.peek(r) || r.kind != kind) {
+        // leave the record for whoever it belongs to
+        ++mismatch_count;
+        x = y = z = 0.0f;
+        return;
+    }
+    from.next(r);
+    x = r.v[0];
+    y = r.v[1];
+    z = r.v[2];
+}
@@ -0,0 +1,98 @@
+#ifndef IMU_SOURCE_H
+#define IMU_SOURCE_H
+
+#include <stdint.h>
+#include "SensorTrace.h"
+
+#ifdef ARDUINO
+#include <LSM6DS3.h>
+#endif
+
+/**
+ * @class ImuSource
+ * @brief Where IMU gets its readings from: the sensor, the sensor with a trace being written,
+ * or a trace being replayed
+ */
+class ImuSource {
+public:
+    virtual ~ImuSource() {}
+
+    /**
+     * @brief Returns true if the source is ready to read
+     */
+    virtual bool begin() { return true; }
+
+    /**
+     * @brief Angular rate in degrees per second
+     */
+    virtual void readGyro(float& x, float& y, float& z) = 0;
+
+    /**
+     * @brief Acceleration in g
+     * @return false if the source has no more readings until the next readGyro(), a sensor
+     * read on demand always has one
+     */
+    virtual bool readAccel(float& x, float& y, float& z) = 0;
+};
+
+#ifdef ARDUINO
+/**
+ * @class LiveImuSource
+ * @brief The LSM6DS3 on the XIAO expansion board, over I2C
+ */
+class LiveImuSource : public ImuSource {
+public:
+    LiveImuSource() : sensor(I2C_MODE, 0x6A) {}
+
+    bool begin() override;
+    void readGyro(float& x, float& y, float& z) override;
+    bool readAccel(float& x, float& y, float& z) override;
+
+private:
+    LSM6DS3 sensor;
+};
+#endif
+
+/**
+ * @class RecordingImuSource
+ * @brief Passes the readings of another source through and writes each one to a trace
+ */
+class RecordingImuSource : public ImuSource {
+public:
+    RecordingImuSource(ImuSource& from, TraceWriter& to) : from(from), to(to) {}
+
+    bool begin() override { return from.begin(); }
+    void readGyro(float& x, float& y, float& z) override;
+    bool readAccel(float& x, float& y, float& z) override;
+
+private:
+    ImuSource& from;
+    TraceWriter& to;
+};
+
+/**
+ * @class ReplayImuSource
+ * @brief Hands out the readings of a trace in the order they were recorded
+ *
+ * The game has to ask for the same readings as when recording, a reading of the other kind
+ * or a frame or level record where a reading should be means the replay went its own way:
+ * it reads as zero and is counted in mismatches(). The exception is the end of a run of
+ * accelerometer readings, a FIFO source hands out as many as arrived since the last frame.
+ */
+class ReplayImuSource : public ImuSource {
+public:
+    explicit ReplayImuSource(TraceReader& from) : from(from) {}
+
+    void readGyro(float& x, float& y, float& z) override { take(TraceRecord::GYRO, x, y, z); }
+    bool readAccel(float& x, float& y, float& z) override;
+
+    uint32_t mismatches() const { return mismatch_count; }
+
+private:
+    TraceReader& from;
+    uint32_t mismatch_count = 0;
+
+    void take(char kind, float& x, float& y, float& z);
+};
+
+#endif // IMU_SOURCE_H
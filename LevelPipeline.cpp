@@ -0,0 +1,74 @@
+#include "LevelPipeline.h"
+#include <Arduino.h>
+
+void LevelPipeline::prepare(const MazeId& id) {
+    cancel();
+
+    maze = createMaze(id);
+    if (!maze) return;
+
+    // A screen that is never loaded is not rendered, so objects can be added to it freely
+    screen = lv_obj_create(nullptr);
+    lv_obj_set_style_bg_color(screen, lv_color_black(), 0);
+
+    maze->beginGenerate();
+    stage = Stage::Generating;
+}
+
+
+bool LevelPipeline::workChunk() {
+    switch (stage) {
+        case Stage::Generating:
+            if (maze->generateStep(GENERATE_CHUNK)) {
+                maze->beginDraw(screen);
+                stage = Stage::Drawing;
+            }
+            break;
+        case Stage::Drawing:
+            if (maze->drawStep(DRAW_CHUNK)) {
+                stage = maze->wallLayer().beginRaster(raster) ? Stage::Rasterizing : fieldStage();
+            }
+            break;
+        case Stage::Rasterizing:
+            if (maze->wallLayer().rasterStep(RASTER_CHUNK)) stage = fieldStage();
+            break;
+        case Stage::BuildingField:
+            if (maze->wallFieldStep(FIELD_CHUNK)) stage = Stage::Ready;
+            break;
+        default:
+            break;
+    }
+    return stage == Stage::Ready || stage == Stage::Idle;
+}
+
+
+void LevelPipeline::service(uint32_t budget_us) {
+    const uint32_t start = micros();
+    while (!workChunk()) {
+        if (micros() - start >= budget_us) break;
+    }
+}
+
+
+void LevelPipeline::finish() {
+    while (!workChunk()) {}
+}
+
+
+Maze* LevelPipeline::take(lv_obj_t** out_screen) {
+    if (stage != Stage::Ready) return nullptr;
+
+    Maze* m = maze;
+    *out_screen = screen;
+    maze = nullptr;
+    screen = nullptr;
+    stage = Stage::Idle;
+    return m;
+}
+
+
+void LevelPipeline::cancel() {
+    if (maze) { delete maze; maze = nullptr; }
+    if (screen) { lv_obj_del(screen); screen = nullptr; }
+    stage = Stage::Idle;
+}
@@ -0,0 +1,83 @@
+#ifndef LEVEL_PIPELINE_H
+#define LEVEL_PIPELINE_H
+
+#include <lvgl.h>
+#include "maze.h"
+
+/**
+ * @class LevelPipeline
+ * @brief Builds the next level (maze generation + LVGL screen) off-screen in small time slices
+ * while the current level is still being played, so switching levels is just a screen load.
+ */
+class LevelPipeline {
+public:
+    enum class Stage : uint8_t { Idle, Generating, Drawing, Rasterizing, BuildingField, Ready };
+
+    ~LevelPipeline() { cancel(); }
+
+    /**
+     * @brief Starts building the maze described by id on a new, not yet loaded screen
+     */
+    void prepare(const MazeId& id);
+
+    /**
+     * @brief Does pipeline work until budget_us microseconds have passed or the level is ready
+     */
+    void service(uint32_t budget_us);
+
+    /**
+     * @brief Completes the remaining work right away (fallback when the exit is hit early)
+     */
+    void finish();
+
+    /**
+     * @brief Pre-renders the walls of every following level in this format once they are drawn
+     */
+    void setWallRaster(WallRaster format) { raster = format; }
+
+    /**
+     * @brief Builds the wall distance field of every following level once it is drawn, for
+     * levels played with CollisionMode::DistanceField
+     */
+    void setWallField(bool on) { wall_field = on; }
+
+    bool isReady() const { return stage == Stage::Ready; }
+    Stage getStage() const { return stage; }
+
+    /**
+     * @brief Hands the finished maze and its screen over to the caller, the pipeline goes idle
+     * @param screen receives the screen the maze was drawn on
+     * @return the maze, or nullptr if nothing is ready
+     */
+    Maze* take(lv_obj_t** screen);
+
+    /**
+     * @brief Drops any level in progress
+     */
+    void cancel();
+
+private:
+    // Work done between two clock checks, small enough to stay well inside one slice
+    static constexpr uint32_t GENERATE_CHUNK = 32; // cells
+    static constexpr uint32_t DRAW_CHUNK = 32;     // walls, a few points each in the wall layer
+    static constexpr uint32_t RASTER_CHUNK = 8;    // walls rendered into the canvas
+    static constexpr uint32_t FIELD_CHUNK = 4;     // walls added to the distance field
+
+    Stage stage = Stage::Idle;
+    Maze* maze = nullptr;
+    lv_obj_t* screen = nullptr;
+    WallRaster raster = WallRaster::Off;
+    bool wall_field = false;
+
+    /**
+     * @brief Stage after the walls are drawn and rasterized
+     */
+    Stage fieldStage() const { return wall_field ? Stage::BuildingField : Stage::Ready; }
+
+    /**
+     * @brief Runs one chunk of the current stage, returns true once the level is ready
+     */
+    bool workChunk();
+};
+
+#endif // LEVEL_PIPELINE_H
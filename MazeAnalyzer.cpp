@@ -0,0 +1,58 @@
+#include "MazeAnalyzer.h"
+
+// dist.assign() takes it by reference, which needs a definition before C++17
+constexpr uint16_t MazeAnalyzer::UNREACHED;
+
+void MazeAnalyzer::reserve(int cells) {
+    dist.assign(cells, UNREACHED);
+    queue.resize(cells);
+    ran = false;
+}
+
+
+const MazeStats& MazeAnalyzer::run(const MazeGrid& grid, int source, int target) {
+    result = MazeStats();
+    const int n = grid.cellCount();
+    if (n > (int)dist.size() || source < 0 || source >= n) return result;
+
+    for (int c = 0; c < n; ++c) dist[c] = UNREACHED;
+
+    // Plain BFS, every cell enters the queue once so the queue never wraps
+    int head = 0, tail = 0;
+    dist[source] = 0;
+    queue[tail++] = source;
+
+    int nb[MazeGrid::MAX_NEIGHBORS];
+    int branches = 0, corridors = 0;
+    while (head < tail) {
+        int c = queue[head++];
+        uint16_t d = dist[c];
+        if (d > result.max_distance || result.farthest_cell < 0) {
+            result.max_distance = d;
+            result.farthest_cell = c;
+        }
+
+        int k = grid.openNeighbors(c, nb);
+        if (k == 1) ++result.dead_ends;
+        else if (k >= 3) ++result.junctions;
+        if (k >= 2) { branches += k - 1; ++corridors; }
+
+        for (int i = 0; i < k; ++i) {
+            if (dist[nb[i]] != UNREACHED) continue;
+            dist[nb[i]] = (d + 1 < UNREACHED) ? d + 1 : UNREACHED - 1;
+            queue[tail++] = nb[i];
+        }
+    }
+
+    result.reachable = tail;
+    result.branching_factor = corridors ? (float)branches / corridors : 0.0f;
+    ran = true;
+    setTarget(target);
+    return result;
+}
+
+
+void MazeAnalyzer::setTarget(int target) {
+    uint16_t d = distance(target);
+    result.solution_length = (d == UNREACHED) ? -1 : d;
+}
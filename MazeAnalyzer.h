@@ -0,0 +1,62 @@
+#ifndef MAZE_ANALYZER_H
+#define MAZE_ANALYZER_H
+
+#include <stdint.h>
+#include <vector>
+#include "MazeGenerator.h"
+
+/**
+ * @brief Summary of a generated maze as seen from one source cell
+ */
+struct MazeStats {
+    int reachable = 0;         ///< cells reached from the source (all of them in a perfect maze)
+    int farthest_cell = -1;    ///< cell with the longest distance to the source
+    int max_distance = 0;      ///< distance of farthest_cell in steps
+    int solution_length = -1;  ///< steps from the source to the target, -1 if unreachable
+    int dead_ends = 0;         ///< cells with exactly one opening
+    int junctions = 0;         ///< cells with three or more openings
+    float branching_factor = 0.0f; ///< average number of ways on (openings - 1) over cells that are not dead ends
+};
+
+/**
+ * @class MazeAnalyzer
+ * @brief Breadth first distance field and maze statistics in one linear pass.
+ *
+ * Buffers are sized once with reserve(), run() itself never allocates. Distances are 16 bit,
+ * so grids of up to MAX_CELLS cells; MazeId rejects the adaptive polar layouts that are larger.
+ */
+class MazeAnalyzer {
+public:
+    static constexpr uint16_t UNREACHED = 0xFFFF;
+    static constexpr long MAX_CELLS = 0xFFFF;
+
+    /**
+     * @brief Allocates the distance and queue buffers for a grid of this many cells
+     */
+    void reserve(int cells);
+
+    /**
+     * @brief Computes the distance of every cell from source plus the maze statistics
+     * @param grid maze to walk, only openings (openNeighbors) are followed
+     * @param source cell distances are measured from
+     * @param target cell whose distance becomes the solution length, may be -1
+     */
+    const MazeStats& run(const MazeGrid& grid, int source, int target);
+
+    /**
+     * @brief Updates solution_length for another target without walking the maze again
+     */
+    void setTarget(int target);
+
+    uint16_t distance(int cell) const { return cell >= 0 && cell < (int)dist.size() ? dist[cell] : UNREACHED; }
+    const MazeStats& stats() const { return result; }
+    bool hasRun() const { return ran; }
+
+private:
+    std::vector<uint16_t> dist;
+    std::vector<int> queue;
+    MazeStats result;
+    bool ran = false;
+};
+
+#endif // MAZE_ANALYZER_H
@@ -0,0 +1,124 @@
+// Host benchmark of the maze analysis pass (MazeAnalyzer::run), not part of the sketch (the
+// Arduino build compiles this file to nothing). The maze classes link against LVGL, so this
+// needs the host setup of the trace replay (see TraceRunner.h): LVGL 8.3 with an lv_conf.h and
+// an Arduino.h providing micros(). Build and run on a PC:
+//
+//   g++ -std=gnu++11 -O2 -I. -I<lvgl> -I<Arduino.h> -o analyzer_bench MazeAnalyzerBench.cpp $MAZE_SOURCES <LVGL library>
+//   ./analyzer_bench
+//
+// with MAZE_SOURCES as in FixedMazeBench.cpp. Generates the default 10x10 rectangular and
+// 10 ring circular mazes with every algorithm and a range of seeds, then times the pass from
+// the spawn the way finishGenerate() runs it. Fails if a pass goes over BUDGET_US or allocates.
+
+#ifndef ARDUINO
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <chrono>
+#include "RectangularMaze.h"
+#include "CircularMaze.h"
+
+static const double BUDGET_US = 1000.0;
+static const int SEEDS = 20;
+static const int PASSES = 2000;  // per maze, timed together
+
+// Every allocation of the process, to check that run() itself never allocates
+static long allocations = 0;
+
+void* operator new(size_t size) {
+    ++allocations;
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+
+// The mazes keep their graph view protected, the analysis walks it
+class BenchRectangularMaze : public RectangularMaze {
+public:
+    BenchRectangularMaze() : RectangularMaze(10, 10, 16, 40) {}
+    const ::MazeGrid& graph() const { return grid(); }
+};
+
+class BenchCircularMaze : public CircularMaze {
+public:
+    BenchCircularMaze() : CircularMaze(10, 16, 11) {}
+    const ::MazeGrid& graph() const { return grid(); }
+};
+
+
+static const char* algorithmName(MazeAlgorithm a) {
+    switch (a) {
+        case MazeAlgorithm::Backtracker: return "Backtracker";
+        case MazeAlgorithm::Kruskal:     return "Kruskal";
+        case MazeAlgorithm::Prim:        return "Prim";
+        case MazeAlgorithm::Wilson:      return "Wilson";
+        case MazeAlgorithm::Sidewinder:  return "Sidewinder";
+        case MazeAlgorithm::Eller:       return "Eller";
+    }
+    return "?";
+}
+
+
+/**
+ * @brief Times the pass on SEEDS mazes of one algorithm
+ * @return number of failures (over budget or allocating)
+ */
+template <typename BenchMaze>
+static int bench(const char* name, BenchMaze& maze, MazeAlgorithm algorithm) {
+    MazeAnalyzer analyzer;
+    analyzer.reserve(maze.graph().cellCount());
+    maze.setAlgorithm(algorithm);
+
+    double mean_us = 0.0, worst_us = 0.0;
+    long solution = 0, dead_ends = 0, allocated = 0;
+    for (int seed = 1; seed <= SEEDS; ++seed) {
+        maze.setSeed(seed);
+        maze.generate();
+        const lv_point_t spawn = maze.getBallSpawnPixel();
+        const int source = maze.cellAtPixel(spawn.x, spawn.y);
+        const int target = maze.exitCell();
+
+        const long before = allocations;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < PASSES; ++i) analyzer.run(maze.graph(), source, target);
+        const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / PASSES;
+        allocated += allocations - before;
+
+        mean_us += us / SEEDS;
+        if (us > worst_us) worst_us = us;
+        solution += analyzer.stats().solution_length;
+        dead_ends += analyzer.stats().dead_ends;
+    }
+
+    const bool ok = worst_us < BUDGET_US && allocated == 0;
+    printf("%-10s %-12s %6d %9.2f %9.2f %9.1f %9.1f %6ld %s\n", name, algorithmName(algorithm),
+           maze.graph().cellCount(), mean_us, worst_us, (double)solution / SEEDS, (double)dead_ends / SEEDS,
+           allocated, ok ? "ok" : "FAIL");
+    fflush(stdout);
+    return ok ? 0 : 1;
+}
+
+
+int main() {
+    static const MazeAlgorithm ALGORITHMS[] = {
+        MazeAlgorithm::Backtracker, MazeAlgorithm::Kruskal, MazeAlgorithm::Prim,
+        MazeAlgorithm::Wilson, MazeAlgorithm::Sidewinder, MazeAlgorithm::Eller
+    };
+    int failures = 0;
+
+    printf("%-10s %-12s %6s %9s %9s %9s %9s %6s\n", "maze", "algorithm", "cells", "mean us", "worst us",
+           "solution", "dead ends", "allocs");
+    BenchRectangularMaze rect;
+    for (MazeAlgorithm a : ALGORITHMS) failures += bench("rect 10x10", rect, a);
+    BenchCircularMaze circ;
+    for (MazeAlgorithm a : ALGORITHMS) failures += bench("circ 10x16", circ, a);
+
+    printf("budget %.0f us per pass\n", BUDGET_US);
+    return failures == 0 ? 0 : 1;
+}
+
+#endif // ARDUINO
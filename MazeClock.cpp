@@ -8,105 +8,116 @@
 extern I2C_BM8563 rtc;
 
 
-MazeClock::MazeClock(int rings, int spacing) : CircularMaze(rings, 12, spacing) {
-    hour_arc = nullptr;
-    minute_arc = nullptr;
+lv_style_t MazeClock::style_hour_arc;
+lv_style_t MazeClock::style_minute_arc;
+lv_style_t MazeClock::style_clock_num;
+bool MazeClock::style_initialized = false;
+
+
+MazeClock::MazeClock(int rings, int spacing) : CircularMaze(rings, 12, spacing) {}
+
+
+MazeClock::~MazeClock() {
+    // the screen may outlive the maze, take the face with us like the wall layer does
+    if (face) lv_obj_del(face);
+}
+
+
+MazeId MazeClock::getId() const {
+    MazeId id = CircularMaze::getId();
+    id.type = MazeType::Clock;
+    id.dims[0] = NUM_RINGS;
+    id.dims[1] = RING_SPACING;
+    id.dims[2] = 0;
+    return id;
 }
 
 
 void MazeClock::draw(lv_obj_t* parent, bool animate) {
     generate();
-    wall_buffer_idx = 0; // Reset buffer index each time we redraw
-
-    // LVGL One-time style init for wall lines
-    static lv_style_t style_wall_circular;
-    lv_style_init(&style_wall_circular);
-    lv_style_set_line_width(&style_wall_circular, 2);
-    lv_style_set_line_color(&style_wall_circular, lv_color_white());
-    lv_style_set_line_rounded(&style_wall_circular, true);
-
-    const float angle_step = 2 * M_PI / SECTORS_PER_RING;
-
-    // Draw Radial Walls (Spokes) note that r < NUM_RINGS not r < NUM_RINGS - 1
-    for (int r = 1; r < NUM_RINGS; r++) {
-        for (int s = 0; s < SECTORS_PER_RING; s++) {
-            if (r < NUM_RINGS && radial_walls[r][s]) {
-                float angle = s * angle_step;
-                float r1 = (r + 1) * RING_SPACING;
-                float r2 = (r + 2) * RING_SPACING;
-
-                if (wall_buffer_idx < point_buffer.size()) {
-                    point_buffer[wall_buffer_idx][0] = {(lv_coord_t)(CENTER_X + cos(angle) * r1), (lv_coord_t)(CENTER_Y + sin(angle) * r1)};
-                    point_buffer[wall_buffer_idx][1] = {(lv_coord_t)(CENTER_X + cos(angle) * r2), (lv_coord_t)(CENTER_Y + sin(angle) * r2)};
-                    
-                    lv_obj_t *wall = lv_line_create(parent);
-                    lv_line_set_points(wall, point_buffer[wall_buffer_idx].data(), 2);
-                    lv_obj_add_style(wall, &style_wall_circular, 0);
-                    wall_buffer_idx++;
-                    if (animate) lv_timer_handler();
-                }
-            }
+    CircularMaze::draw(parent, animate);
+}
+
+
+void MazeClock::beginDraw(lv_obj_t* parent) {
+    CircularMaze::beginDraw(parent);
+    // a face on another screen can't be reused
+    if (face && lv_obj_get_parent(face) != parent) lv_obj_del(face);
+}
+
+
+bool MazeClock::drawStep(uint32_t max_walls) {
+    const int spoke_slots = (NUM_RINGS - 1) * SECTORS_PER_RING;
+    const int total_slots = 2 * spoke_slots;
+
+    while (draw_cursor < total_slots && max_walls > 0) {
+        int k = draw_cursor++;
+        if (k < spoke_slots) {
+            // Draw Radial Walls (Spokes) across rings 2..NUM_RINGS, same ring indexing as the
+            // collision code. Ring NUM_RINGS is past the maze, its spokes work as hour ticks
+            int ring = 2 + k / SECTORS_PER_RING, s = k % SECTORS_PER_RING;
+            if (ring < NUM_RINGS && !(wallsAt(ring, s) & SPOKE_CCW)) continue;
+            // every ring has 12 sectors, the outer ring's directions serve the ticks too
+            addSpoke(table->boundary(NUM_RINGS - 1, s), ring * RING_SPACING, (ring + 1) * RING_SPACING);
+        } else {
+            // Draw Circular Walls (Arcs)
+            k -= spoke_slots;
+            int r = 1 + k / SECTORS_PER_RING, s = k % SECTORS_PER_RING;
+            if (!(wallsAt(r, s) & ARC_OUT)) continue;
+            addArc(r, s);
         }
+        --max_walls;
     }
-    
-    // Draw Circular Walls (Arcs)
-    for (int r = 1; r < NUM_RINGS; r++) {
-        for (int s = 0; s < SECTORS_PER_RING; s++) {
-            if (circular_walls[r][s]) {
-                if (wall_buffer_idx < point_buffer.size()) {
-                    float radius = (r + 1) * RING_SPACING;
-                    float start_angle = s * angle_step;
-                    
-                    for(int i = 0; i <= POINTS_PER_ARC; i++) {
-                        float current_angle = start_angle + (float)i * (angle_step / POINTS_PER_ARC);
-                        point_buffer[wall_buffer_idx][i].x = (lv_coord_t)(CENTER_X + cos(current_angle) * radius);
-                        point_buffer[wall_buffer_idx][i].y = (lv_coord_t)(CENTER_Y + sin(current_angle) * radius);
-                    }
-
-                    lv_obj_t *arc_wall = lv_line_create(parent);
-                    lv_line_set_points(arc_wall, point_buffer[wall_buffer_idx].data(), POINTS_PER_ARC + 1);
-                    lv_obj_add_style(arc_wall, &style_wall_circular, 0);
-                    wall_buffer_idx++;
-
-                    if (animate) lv_timer_handler();
-                }
-            }
-        }
+    wall_layer.flush();
+    if (draw_cursor < total_slots) return false;
+
+    if (draw_cursor == total_slots) {
+        // Only the walls change with a new maze, the face is built once
+        if (!face) buildFace(draw_parent);
+        updateTime();
+        draw_cursor++;
     }
+    return true;
+}
 
-    // Clock LVGL
-    I2C_BM8563_TimeTypeDef timeStruct;
-    rtc.getTime(&timeStruct);
 
-    static lv_style_t style_hour_arc, style_minute_arc;
+void MazeClock::buildFace(lv_obj_t* parent) {
+    if (!style_initialized) {
+        // Style for the red hour arc
+        lv_style_init(&style_hour_arc);
+        lv_style_set_arc_color(&style_hour_arc, lv_palette_main(LV_PALETTE_RED));
+        lv_style_set_arc_width(&style_hour_arc, 10); // Set arc thickness
+        lv_style_set_arc_rounded(&style_hour_arc, true);
 
-    // Style for the red hour arc
-    lv_style_init(&style_hour_arc);
-    lv_style_set_arc_color(&style_hour_arc, lv_palette_main(LV_PALETTE_RED));
-    lv_style_set_arc_width(&style_hour_arc, 10); // Set arc thickness
-    lv_style_set_arc_rounded(&style_hour_arc, true);
+        // Style for the blue minute arc
+        lv_style_init(&style_minute_arc);
+        lv_style_set_arc_color(&style_minute_arc, lv_palette_main(LV_PALETTE_BLUE));
+        lv_style_set_arc_width(&style_minute_arc, 8);
+        lv_style_set_arc_rounded(&style_minute_arc, true);
 
-    // Style for the blue minute arc
-    lv_style_init(&style_minute_arc);
-    lv_style_set_arc_color(&style_minute_arc, lv_palette_main(LV_PALETTE_BLUE));
-    lv_style_set_arc_width(&style_minute_arc, 8);
-    lv_style_set_arc_rounded(&style_minute_arc, true);
+        lv_style_init(&style_clock_num);
+        lv_style_set_text_color(&style_clock_num, lv_color_white());
+        style_initialized = true;
+    }
 
-    // Draws the numbers 1 through 12, aligned with the maze spokes.
-    static lv_style_t style_clock_num;
-    lv_style_init(&style_clock_num);
-    lv_style_set_text_color(&style_clock_num, lv_color_white());
+    // One transparent container for everything, so a redraw can keep it as a whole
+    face = lv_obj_create(parent);
+    lv_obj_remove_style_all(face);
+    lv_obj_set_size(face, LV_PCT(100), LV_PCT(100));
+    lv_obj_clear_flag(face, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(face, faceDeleteEvent, LV_EVENT_DELETE, this);
 
+    // Draws the numbers 1 through 12, aligned with the maze spokes.
     float radius = (NUM_RINGS + 2) * RING_SPACING;
 
-    // Loop through each sector `s` from 0 to 11
+    // Loop through each sector `s` from 0 to 11, the numbers sit on the spoke directions
     for (int s = 0; s < SECTORS_PER_RING; s++) {
-        float angle = s * angle_step;
+        const PolarDir& dir = table->boundary(NUM_RINGS - 1, s);
 
-        lv_coord_t x = (lv_coord_t)(radius * cos(angle));
-        lv_coord_t y = (lv_coord_t)(radius * sin(angle));
+        lv_coord_t x = (lv_coord_t)(radius * dir.x);
+        lv_coord_t y = (lv_coord_t)(radius * dir.y);
 
-        lv_obj_t* label = lv_label_create(parent);
+        lv_obj_t* label = lv_label_create(face);
         lv_obj_add_style(label, &style_clock_num, 0);
 
         // This formula maps sector 0 (3 o'clock) to hour 3, sector 9 (12 o'clock) to hour 12, etc.
@@ -117,76 +128,67 @@ void MazeClock::draw(lv_obj_t* parent, bool animate) {
         lv_obj_set_pos(label, x, y);
     }
 
-    // Hour indicator arc
-    hour_arc = lv_arc_create(parent);
-    lv_obj_add_style(hour_arc, &style_hour_arc, LV_PART_INDICATOR);
-    lv_obj_remove_style(hour_arc, NULL, LV_PART_KNOB);
-    lv_obj_remove_style(hour_arc, NULL, LV_PART_MAIN);
-
-    // Calculate the hour's position as an angle from 0 to 360
-    float hour_value = (timeStruct.hours % 12) + (timeStruct.minutes / 60.0f);
-    float hour_center_angle = (hour_value / 12.0f) * 360;
-
-    // Define the arc segment's length (e.g., 20 degrees wide)
-    int hour_arc_length = 20;
-    // Set the start and end angles for the moving segment
-    lv_arc_set_start_angle(hour_arc, hour_center_angle - (hour_arc_length / 2));
-    lv_arc_set_end_angle(hour_arc, hour_center_angle + (hour_arc_length / 2));
-
-    // Rotate the entire widget so that 0 degrees is at the top
-    lv_arc_set_rotation(hour_arc, 270);
-
-    // Set the size and position of the arc widget
-    int hour_diameter = (NUM_RINGS+1) * RING_SPACING * 2;
-    lv_obj_set_size(hour_arc, hour_diameter, hour_diameter);
-    lv_obj_align(hour_arc, LV_ALIGN_CENTER, 0, 0);
-
-
-    // Minute indicator arc 
-    minute_arc = lv_arc_create(parent);
-    lv_obj_add_style(minute_arc, &style_minute_arc, LV_PART_INDICATOR);
-    lv_obj_remove_style(minute_arc, NULL, LV_PART_KNOB);
-    lv_obj_remove_style(minute_arc, NULL, LV_PART_MAIN);
-
-    // Calculate the minute's position as an angle from 0 to 360
-    float minute_center_angle = (timeStruct.minutes / 60.0f) * 360;
-
-    int minute_arc_length = 12;
-    lv_arc_set_start_angle(minute_arc, minute_center_angle - (minute_arc_length / 2));
-    lv_arc_set_end_angle(minute_arc, minute_center_angle + (minute_arc_length / 2));
-
-    // Rotate the entire widget so that 0 degrees is at the top
-    lv_arc_set_rotation(minute_arc, 270);
+    // Both arcs are as big as the maze, the minute arc is the thinner one drawn on top
+    const int diameter = (NUM_RINGS + 1) * RING_SPACING * 2;
+    lv_obj_t** arcs[2] = { &hour_arc, &minute_arc };
+    lv_style_t* styles[2] = { &style_hour_arc, &style_minute_arc };
+    for (int i = 0; i < 2; ++i) {
+        lv_obj_t* arc = lv_arc_create(face);
+        lv_obj_add_style(arc, styles[i], LV_PART_INDICATOR);
+        lv_obj_remove_style(arc, NULL, LV_PART_KNOB);
+        lv_obj_remove_style(arc, NULL, LV_PART_MAIN);
+        lv_obj_clear_flag(arc, LV_OBJ_FLAG_CLICKABLE);
+
+        // Rotate the entire widget so that 0 degrees is at the top
+        lv_arc_set_rotation(arc, 270);
+        lv_obj_set_size(arc, diameter, diameter);
+        lv_obj_align(arc, LV_ALIGN_CENTER, 0, 0);
+        *arcs[i] = arc;
+    }
+    // not pointing anywhere yet
+    hour_deg = -1;
+    minute_deg = -1;
+}
 
-    // Set a slightly smaller size for the minute arc to nest it
-    int minute_diameter = (NUM_RINGS+1) * RING_SPACING * 2;
-    lv_obj_set_size(minute_arc, minute_diameter, minute_diameter);
-    lv_obj_align(minute_arc, LV_ALIGN_CENTER, 0, 0);
 
-    // Final actual draw to screen
-    lv_timer_handler();
+void MazeClock::setHand(lv_obj_t* arc, int center_deg, int length_deg) {
+    // keep both ends in 0..359, the arc wraps around 0 by itself when start > end
+    lv_arc_set_angles(arc, (center_deg + 360 - length_deg / 2) % 360, (center_deg + length_deg / 2) % 360);
 }
 
-void MazeClock::updateTime() {
+
+bool MazeClock::updateTime() {
     // Ensure the arc objects have been created before trying to update them
     if (!hour_arc || !minute_arc) {
-        return;
+        return false;
     }
 
     // Get the current time from the RTC
     I2C_BM8563_TimeTypeDef timeStruct;
     rtc.getTime(&timeStruct);
-    
-    // Update hour arc
-    float hour_value = (timeStruct.hours % 12) + (timeStruct.minutes / 60.0f);
-    float hour_center_angle = (hour_value / 12.0f) * 360;
-    int hour_arc_length = 20;
-    lv_arc_set_start_angle(hour_arc, hour_center_angle - (hour_arc_length / 2));
-    lv_arc_set_end_angle(hour_arc, hour_center_angle + (hour_arc_length / 2));
-
-    // Update minute arc
-    float minute_center_angle = (timeStruct.minutes / 60.0f) * 360;
-    int minute_arc_length = 15;
-    lv_arc_set_start_angle(minute_arc, minute_center_angle - (minute_arc_length / 2));
-    lv_arc_set_end_angle(minute_arc, minute_center_angle + (minute_arc_length / 2));
-}
\ No newline at end of file
+
+    // Hour hand moves half a degree a minute, whole degrees are enough for a 20 degree arc
+    const int16_t new_hour = (timeStruct.hours % 12) * 30 + timeStruct.minutes / 2;
+    const int16_t new_minute = timeStruct.minutes * 6;
+
+    bool changed = false;
+    if (new_hour != hour_deg) {
+        setHand(hour_arc, new_hour, HOUR_ARC_DEG);
+        hour_deg = new_hour;
+        changed = true;
+    }
+    if (new_minute != minute_deg) {
+        setHand(minute_arc, new_minute, MINUTE_ARC_DEG);
+        minute_deg = new_minute;
+        changed = true;
+    }
+    return changed;
+}
+
+
+void MazeClock::faceDeleteEvent(lv_event_t* e) {
+    MazeClock* clock = (MazeClock*)lv_event_get_user_data(e);
+    clock->face = nullptr;
+    clock->hour_arc = nullptr;
+    clock->minute_arc = nullptr;
+}
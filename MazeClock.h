@@ -14,13 +14,54 @@ public:
     // fix it to 12 sectors for the 12 hours of a clock.
     MazeClock(int rings, int spacing);
   
-    // Override the draw function 
+    // Destroys the clock face along with the maze
+    ~MazeClock();
+
+    // Override the draw function, the clock regenerates its maze on every draw
     virtual void draw(lv_obj_t* parent, bool animate) override;
 
-    virtual void updateTime() override;
+    /**
+     * @brief Starts a new wall layer, the clock face stays if it is already on parent
+     */
+    virtual void beginDraw(lv_obj_t* parent) override;
+
+    /**
+     * @brief Adds the next max_walls spokes / arcs to the wall layer, then the clock face (numbers and hand arcs)
+     */
+    virtual bool drawStep(uint32_t max_walls) override;
+
+    /**
+     * @brief Reads the RTC and moves the hands, an arc is only touched when its angle changed
+     * (LVGL then just redraws the slice between the old and new angles)
+     * @return true if a hand moved
+     */
+    virtual bool updateTime() override;
+
+    virtual MazeId getId() const override;
 private:
-    lv_obj_t* hour_arc;
-    lv_obj_t* minute_arc;
+    static constexpr int HOUR_ARC_DEG = 20;   // length of the hour hand arc
+    static constexpr int MINUTE_ARC_DEG = 12; // length of the minute hand arc
+
+    /**
+     * @brief Builds the hour numbers and the hour / minute arcs in one container on parent
+     */
+    void buildFace(lv_obj_t* parent);
+
+    /**
+     * @brief Points an arc of length_deg at center_deg (clockwise from 12 o'clock)
+     */
+    static void setHand(lv_obj_t* arc, int center_deg, int length_deg);
+
+    static void faceDeleteEvent(lv_event_t* e);
+
+    lv_obj_t* face = nullptr;       ///< numbers and hands, built once per parent
+    lv_obj_t* hour_arc = nullptr;
+    lv_obj_t* minute_arc = nullptr;
+    int16_t hour_deg = -1;          ///< angles on screen, -1 before the first update
+    int16_t minute_deg = -1;
+
+    static lv_style_t style_hour_arc, style_minute_arc, style_clock_num;
+    static bool style_initialized;
 };
 
 #endif // MAZE_CLOCK_H
\ No newline at end of file
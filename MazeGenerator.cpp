@@ -0,0 +1,262 @@
+#include "MazeGenerator.h"
+
+MazeGenerator::MazeGenerator(MazeAlgorithm algorithm)
+    : algorithm(algorithm) {}
+
+
+void MazeGenerator::begin(MazeGrid& g, int start_cell, MazeRandom& r) {
+    grid = &g;
+    rng = &r;
+    done = false;
+    peak_bytes = 0;
+
+    const int n = grid->cellCount();
+    visited.assign((n + 31) / 32, 0u);
+    cells.clear();
+    in_frontier.clear();
+    edges.clear();
+    cursor = 0;
+    walk_start = walk_pos = -1;
+    row = 0;
+    run_start = 0;
+    remaining = n;
+
+    if (n <= 0) { done = true; return; }
+    if (start_cell < 0 || start_cell >= n) start_cell = 0;
+
+    int nb[MazeGrid::MAX_NEIGHBORS];
+    switch (algorithm) {
+        case MazeAlgorithm::Backtracker:
+            markVisited(start_cell);
+            cells.push_back(start_cell);
+            break;
+
+        case MazeAlgorithm::Kruskal:
+        case MazeAlgorithm::Eller:
+            // every edge once (a < b) packed in 4 bytes, cells doubles as the union-find parent table
+            for (int c = 0; c < n; ++c) {
+                int k = grid->neighbors(c, nb);
+                for (int i = 0; i < k; ++i) {
+                    if (nb[i] > c) edges.push_back(((uint32_t)c << 3) | (uint32_t)i);
+                }
+            }
+            cells.resize(n);
+            for (int c = 0; c < n; ++c) cells[c] = c;
+            remaining = n - 1; // counts links left rather than cells
+            break;
+
+        case MazeAlgorithm::Prim: {
+            in_frontier.assign(n, 0);
+            markVisited(start_cell);
+            int k = grid->neighbors(start_cell, nb);
+            for (int i = 0; i < k; ++i) {
+                in_frontier[nb[i]] = 1;
+                cells.push_back(nb[i]);
+            }
+            break;
+        }
+
+        case MazeAlgorithm::Wilson:
+            cells.assign(n, -1); // next cell of the current walk, overwritten on revisits (loop erasure)
+            markVisited(start_cell);
+            break;
+
+        case MazeAlgorithm::Sidewinder:
+            cursor = grid->rowStart(0);
+            run_start = (int)cursor;
+            break;
+    }
+    trackPeak();
+}
+
+
+bool MazeGenerator::step(uint32_t budget) {
+    if (done || !grid || !rng) return true;
+
+    switch (algorithm) {
+        case MazeAlgorithm::Backtracker: done = stepBacktracker(budget); break;
+        case MazeAlgorithm::Kruskal:
+        case MazeAlgorithm::Eller:       done = stepKruskal(budget);     break;
+        case MazeAlgorithm::Prim:        done = stepPrim(budget);        break;
+        case MazeAlgorithm::Wilson:      done = stepWilson(budget);      break;
+        case MazeAlgorithm::Sidewinder:  done = stepSidewinder(budget);  break;
+    }
+    if (done) trackPeak();
+    return done;
+}
+
+
+void MazeGenerator::run(MazeGrid& g, int start_cell, MazeRandom& r) {
+    begin(g, start_cell, r);
+    while (!step(UINT32_MAX)) {}
+    release();
+}
+
+
+void MazeGenerator::release() {
+    std::vector<uint32_t>().swap(visited);
+    std::vector<int>().swap(cells);
+    std::vector<uint8_t>().swap(in_frontier);
+    std::vector<uint32_t>().swap(edges);
+}
+
+
+void MazeGenerator::trackPeak() {
+    // capacities never shrink while generating, so sampling them at the start and end is enough
+    size_t bytes = visited.capacity() * sizeof(uint32_t)
+                 + cells.capacity() * sizeof(int)
+                 + in_frontier.capacity() * sizeof(uint8_t)
+                 + edges.capacity() * sizeof(uint32_t);
+    if (bytes > peak_bytes) peak_bytes = bytes;
+}
+
+
+int MazeGenerator::findRoot(int c) {
+    // path halving keeps the trees flat without a second pass
+    while (cells[c] != c) {
+        cells[c] = cells[cells[c]];
+        c = cells[c];
+    }
+    return c;
+}
+
+
+bool MazeGenerator::stepBacktracker(uint32_t budget) {
+    int nb[MazeGrid::MAX_NEIGHBORS];
+    while (budget-- && !cells.empty()) {
+        int c = cells.back();
+
+        // keep only unvisited neighbours and pick one of them, a single draw per carved cell
+        int k = grid->neighbors(c, nb);
+        int open = 0;
+        for (int i = 0; i < k; ++i) {
+            if (!isVisited(nb[i])) nb[open++] = nb[i];
+        }
+        if (open == 0) { cells.pop_back(); continue; }
+
+        int next = nb[open == 1 ? 0 : rng->below(open)];
+        grid->link(c, next);
+        markVisited(next);
+        cells.push_back(next);
+    }
+    return cells.empty();
+}
+
+
+bool MazeGenerator::stepKruskal(uint32_t budget) {
+    int nb[MazeGrid::MAX_NEIGHBORS];
+    const size_t m = edges.size();
+    while (budget-- && cursor < m && remaining > 0) {
+        // Fisher-Yates, one swap per consumed edge so the shuffle is spread over the steps
+        size_t j = cursor + rng->below((uint32_t)(m - cursor));
+        uint32_t e = edges[j];
+        edges[j] = edges[cursor];
+        edges[cursor++] = e;
+
+        int a = (int)(e >> 3);
+        grid->neighbors(a, nb);
+        int b = nb[e & 7u];
+
+        int ra = findRoot(a);
+        int rb = findRoot(b);
+        if (ra == rb) continue;
+        cells[ra] = rb;
+        grid->link(a, b);
+        --remaining;
+    }
+    return cursor >= m || remaining == 0;
+}
+
+
+bool MazeGenerator::stepPrim(uint32_t budget) {
+    int nb[MazeGrid::MAX_NEIGHBORS];
+    while (budget-- && !cells.empty()) {
+        // pull a random frontier cell out by swapping it with the last one
+        size_t idx = rng->below((uint32_t)cells.size());
+        int c = cells[idx];
+        cells[idx] = cells.back();
+        cells.pop_back();
+
+        int k = grid->neighbors(c, nb);
+        int in_maze = 0;
+        for (int i = 0; i < k; ++i) {
+            int o = nb[i];
+            if (isVisited(o)) {
+                nb[in_maze++] = o;
+            } else if (!in_frontier[o]) {
+                in_frontier[o] = 1;
+                cells.push_back(o);
+            }
+        }
+        grid->link(c, nb[in_maze == 1 ? 0 : rng->below(in_maze)]);
+        markVisited(c);
+    }
+    return cells.empty();
+}
+
+
+bool MazeGenerator::stepWilson(uint32_t budget) {
+    int nb[MazeGrid::MAX_NEIGHBORS];
+    const int n = grid->cellCount();
+    while (budget-- && remaining > 0) {
+        if (walk_pos < 0) {
+            while ((int)cursor < n && isVisited((int)cursor)) ++cursor;
+            walk_start = walk_pos = (int)cursor;
+        }
+
+        int k = grid->neighbors(walk_pos, nb);
+        int next = nb[rng->below(k)];
+        cells[walk_pos] = next;
+        walk_pos = next;
+        if (!isVisited(next)) continue;
+
+        // walk hit the maze, carve along the loop-erased path
+        for (int c = walk_start; !isVisited(c); c = cells[c]) {
+            grid->link(c, cells[c]);
+            markVisited(c);
+        }
+        walk_pos = -1;
+    }
+    return remaining == 0;
+}
+
+
+bool MazeGenerator::stepSidewinder(uint32_t budget) {
+    const int n = grid->cellCount();
+    while (budget-- && (int)cursor < n) {
+        int c = (int)cursor++;
+        int row_end = grid->rowStart(row + 1);
+        bool at_end = (c + 1 >= row_end);
+
+        if (row == 0) {
+            // first row has nothing to the north, so it is one long corridor
+            if (!at_end) grid->link(c, c + 1);
+        } else if (!at_end && rng->coin()) {
+            grid->link(c, c + 1);
+        } else {
+            // close the run and open it to the north from a random cell in it
+            int k = run_start + (int)rng->below(c - run_start + 1);
+            int north = grid->northOf(k);
+            if (north < 0) {
+                // some grids (triangles) have cells without a north neighbour, use the first one that has one
+                for (k = run_start; k <= c && (north = grid->northOf(k)) < 0; ++k) {}
+            }
+            if (north >= 0) {
+                grid->link(k, north);
+                run_start = c + 1;
+            } else if (run_start > grid->rowStart(row)) {
+                // no way north at all, join the run to the previous one in this row instead
+                grid->link(run_start - 1, run_start);
+                run_start = c + 1;
+            } else if (!at_end) {
+                grid->link(c, c + 1); // keep the run open until it reaches a cell with a north neighbour
+            }
+        }
+
+        if (at_end) {
+            ++row;
+            run_start = c + 1;
+        }
+    }
+    return (int)cursor >= n;
+}
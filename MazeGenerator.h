@@ -0,0 +1,144 @@
+#ifndef MAZE_GENERATOR_H
+#define MAZE_GENERATOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "MazeRandom.h"
+
+/**
+ * @brief Spanning tree algorithms the generator can carve a maze with.
+ */
+enum class MazeAlgorithm : uint8_t {
+    Backtracker, ///< Depth first search, long winding corridors
+    Kruskal,     ///< Random edge order + union-find, many short dead ends
+    Prim,        ///< Random frontier growth, radial "bushy" look
+    Wilson,      ///< Loop-erased random walks, uniform spanning tree
+    Sidewinder,  ///< Row by row runs, one straight corridor along the first row
+    Eller        ///< Row by row set merging, streamed by EllerGenerator on rectangular mazes.
+                 ///< Other grids have no fixed row width and carve it as Kruskal.
+};
+
+/**
+ * @class MazeGrid
+ * @brief Minimal view of a maze's cells that the generator carves into.
+ *
+ * Cells are numbered 0..cellCount()-1 row by row, so the cells of one row are contiguous
+ * and the "east" neighbour of a cell is simply the next index in the same row.
+ */
+class MazeGrid {
+public:
+    static constexpr int MAX_NEIGHBORS = 8;
+
+    virtual ~MazeGrid() {}
+
+    virtual int cellCount() const = 0;
+    virtual int rowCount() const = 0;
+
+    /**
+     * @brief Index of the first cell of a row, rowStart(rowCount()) must equal cellCount()
+     */
+    virtual int rowStart(int row) const = 0;
+
+    /**
+     * @brief Writes every neighbour of cell (walled or not) into out and returns how many there are
+     * @param cell cell index
+     * @param out array of at least MAX_NEIGHBORS entries
+     */
+    virtual int neighbors(int cell, int* out) const = 0;
+
+    /**
+     * @brief Like neighbors() but only the ones reachable without crossing a wall
+     */
+    virtual int openNeighbors(int cell, int* out) const = 0;
+
+    /**
+     * @brief Neighbour in the previous row, or -1 on the first row (or if the cell has none).
+     * Used by row based algorithms, cell and cell + 1 in the same row must be neighbours for those.
+     */
+    virtual int northOf(int cell) const = 0;
+
+    /**
+     * @brief Knocks down the wall between two neighbouring cells.
+     */
+    virtual void link(int a, int b) = 0;
+};
+
+/**
+ * @class MazeGenerator
+ * @brief Iterative, resumable spanning tree generator shared by all maze types.
+ *
+ * No algorithm recurses, all working state lives in heap buffers owned by the generator so
+ * grid size is bounded by RAM instead of stack depth. Work can be split over several calls
+ * to step() to keep the main loop responsive.
+ */
+class MazeGenerator {
+public:
+    explicit MazeGenerator(MazeAlgorithm algorithm = MazeAlgorithm::Backtracker);
+
+    void setAlgorithm(MazeAlgorithm a) { algorithm = a; }
+    MazeAlgorithm getAlgorithm() const { return algorithm; }
+
+    /**
+     * @brief Resets working buffers for a new maze. All walls of grid must already be up.
+     * @param grid grid to carve into, has to outlive the generation
+     * @param start_cell first cell added to the maze (ignored by Kruskal and Sidewinder)
+     * @param rng random source, has to outlive the generation. Same seed => same maze.
+     */
+    void begin(MazeGrid& grid, int start_cell, MazeRandom& rng);
+
+    /**
+     * @brief Carries on carving for at most budget units of work (roughly one cell or edge each)
+     * @return true once the maze is complete
+     */
+    bool step(uint32_t budget);
+
+    /**
+     * @brief Generates the whole maze in one go, then frees the working buffers.
+     */
+    void run(MazeGrid& grid, int start_cell, MazeRandom& rng);
+
+    bool isDone() const { return done; }
+
+    /**
+     * @brief Frees working buffers, they are otherwise kept for the next maze of the same size.
+     */
+    void release();
+
+    /**
+     * @brief Highest number of bytes held in working buffers since the last begin()
+     */
+    size_t peakBytes() const { return peak_bytes; }
+
+private:
+    MazeAlgorithm algorithm;
+    MazeGrid* grid = nullptr;
+    MazeRandom* rng = nullptr;
+    bool done = true;
+    size_t peak_bytes = 0;
+
+    // Shared state, meaning depends on the algorithm
+    std::vector<uint32_t> visited;   ///< one bit per cell
+    std::vector<int> cells;          ///< DFS stack / Prim frontier / Wilson walk pointers / union-find parents
+    std::vector<uint8_t> in_frontier;///< Prim: cell is in the frontier list
+    std::vector<uint32_t> edges;     ///< Kruskal: cell << 3 | neighbour slot, shuffled lazily as it is consumed
+    size_t cursor = 0;               ///< Kruskal next edge / Wilson first unvisited cell / Sidewinder cell
+    int walk_start = -1;             ///< Wilson: start of the current random walk
+    int walk_pos = -1;               ///< Wilson: head of the current random walk
+    int run_start = 0;               ///< Sidewinder: first cell of the current run
+    int row = 0;                     ///< Sidewinder: current row
+    int remaining = 0;               ///< cells not yet in the maze
+
+    bool isVisited(int c) const { return (visited[c >> 5] >> (c & 31)) & 1u; }
+    void markVisited(int c) { visited[c >> 5] |= 1u << (c & 31); --remaining; }
+    int findRoot(int c);
+    void trackPeak();
+
+    bool stepBacktracker(uint32_t budget);
+    bool stepKruskal(uint32_t budget);
+    bool stepPrim(uint32_t budget);
+    bool stepWilson(uint32_t budget);
+    bool stepSidewinder(uint32_t budget);
+};
+
+#endif // MAZE_GENERATOR_H
@@ -0,0 +1,155 @@
+// Host benchmark of the maze generators, not part of the sketch (the Arduino build compiles
+// this file to nothing). Build and run on a PC:
+//
+//   g++ -std=gnu++11 -O2 -o maze_bench MazeGeneratorBench.cpp MazeGenerator.cpp EllerGenerator.cpp
+//   ./maze_bench
+//
+// Prints time and peak working memory per algorithm from 10x10 up to 2000x2000 and checks
+// that every result is a spanning tree. The generators only need a MazeGrid, so all sizes
+// run here. The game's mazes are smaller: MazeId stores each dimension in a byte
+// (255 cells a side) and MazeAnalyzer keeps 16 bit distances (65535 cells).
+
+#ifndef ARDUINO
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "MazeGenerator.h"
+#include "EllerGenerator.h"
+
+/**
+ * @class BenchGrid
+ * @brief Bare rectangular grid with RectWall masks, the same layout as RectangularMaze
+ */
+class BenchGrid : public MazeGrid {
+public:
+    BenchGrid(int cols, int rows) : cols(cols), rows(rows), walls((size_t)cols * rows) { reset(); }
+
+    void reset() { memset(walls.data(), WALL_N | WALL_S | WALL_W | WALL_E, walls.size()); }
+
+    int cellCount() const override { return cols * rows; }
+    int rowCount() const override { return rows; }
+    int rowStart(int row) const override { return row * cols; }
+
+    int neighbors(int cell, int* out) const override {
+        const int r = cell / cols, c = cell % cols;
+        int n = 0;
+        if (r > 0) out[n++] = cell - cols;
+        if (r < rows - 1) out[n++] = cell + cols;
+        if (c > 0) out[n++] = cell - 1;
+        if (c < cols - 1) out[n++] = cell + 1;
+        return n;
+    }
+
+    int openNeighbors(int cell, int* out) const override {
+        const uint8_t w = walls[cell];
+        int n = 0;
+        if (!(w & WALL_N)) out[n++] = cell - cols;
+        if (!(w & WALL_S)) out[n++] = cell + cols;
+        if (!(w & WALL_W)) out[n++] = cell - 1;
+        if (!(w & WALL_E)) out[n++] = cell + 1;
+        return n;
+    }
+
+    int northOf(int cell) const override { return cell >= cols ? cell - cols : -1; }
+
+    void link(int a, int b) override {
+        if (b < a) { int t = a; a = b; b = t; }
+        if (b == a + 1) { walls[a] &= ~WALL_E; walls[b] &= ~WALL_W; }
+        else            { walls[a] &= ~WALL_S; walls[b] &= ~WALL_N; }
+    }
+
+    uint8_t* row(int r) { return &walls[(size_t)r * cols]; }
+    size_t wallBytes() const { return walls.size(); }
+
+    /**
+     * @brief True if the open passages connect every cell without a loop
+     */
+    bool isSpanningTree() const {
+        const int n = cellCount();
+        long passages = 0;
+        int nb[MAX_NEIGHBORS];
+        for (int c = 0; c < n; ++c) passages += openNeighbors(c, nb);
+        if (passages / 2 != n - 1) return false;
+
+        std::vector<uint8_t> seen(n, 0);
+        std::vector<int> stack(1, 0);
+        seen[0] = 1;
+        int reached = 1;
+        while (!stack.empty()) {
+            const int c = stack.back();
+            stack.pop_back();
+            const int k = openNeighbors(c, nb);
+            for (int i = 0; i < k; ++i) {
+                if (seen[nb[i]]) continue;
+                seen[nb[i]] = 1;
+                ++reached;
+                stack.push_back(nb[i]);
+            }
+        }
+        return reached == n;
+    }
+
+private:
+    int cols, rows;
+    std::vector<uint8_t> walls;
+};
+
+
+static const char* algorithmName(MazeAlgorithm a) {
+    switch (a) {
+        case MazeAlgorithm::Backtracker: return "Backtracker";
+        case MazeAlgorithm::Kruskal:     return "Kruskal";
+        case MazeAlgorithm::Prim:        return "Prim";
+        case MazeAlgorithm::Wilson:      return "Wilson";
+        case MazeAlgorithm::Sidewinder:  return "Sidewinder";
+        case MazeAlgorithm::Eller:       return "Eller";
+    }
+    return "?";
+}
+
+
+int main() {
+    static const int SIZES[] = {10, 100, 500, 1000, 2000};
+    static const MazeAlgorithm ALGORITHMS[] = {
+        MazeAlgorithm::Backtracker, MazeAlgorithm::Kruskal, MazeAlgorithm::Prim,
+        MazeAlgorithm::Wilson, MazeAlgorithm::Sidewinder, MazeAlgorithm::Eller
+    };
+    const uint32_t seed = 1234;
+    int failures = 0;
+
+    printf("%-12s %10s %12s %16s %12s %s\n", "algorithm", "size", "ms", "peak work bytes", "wall bytes", "tree");
+    for (MazeAlgorithm a : ALGORITHMS) {
+        for (int size : SIZES) {
+            BenchGrid grid(size, size);
+            MazeRandom rng(seed);
+            size_t peak = 0;
+
+            const auto t0 = std::chrono::steady_clock::now();
+            if (a == MazeAlgorithm::Eller) {
+                // streamed like RectangularMaze::generateStreaming, rows copied into the grid
+                EllerGenerator eller;
+                eller.begin(size, size, rng);
+                while (eller.nextRow()) memcpy(grid.row(eller.rowIndex()), eller.rowWalls(), size);
+                peak = eller.workingBytes();
+            } else {
+                MazeGenerator generator(a);
+                generator.begin(grid, rng.below(grid.cellCount()), rng);
+                while (!generator.step(UINT32_MAX)) {}
+                peak = generator.peakBytes();
+            }
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+            const bool tree = grid.isSpanningTree();
+            if (!tree) ++failures;
+            char dims[16];
+            snprintf(dims, sizeof(dims), "%dx%d", size, size);
+            printf("%-12s %10s %12.2f %16zu %12zu %s\n", algorithmName(a), dims, ms, peak, grid.wallBytes(), tree ? "ok" : "BROKEN");
+            fflush(stdout);
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+#endif // ARDUINO
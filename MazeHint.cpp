@@ -0,0 +1,71 @@
+#include "MazeHint.h"
+
+lv_style_t MazeHint::style_dot;
+bool MazeHint::style_initialized = false;
+
+static constexpr int DOT_SIZE = 4;
+
+
+void MazeHint::attach(Maze& m, lv_obj_t* parent, int dots) {
+    detach();
+    if (!style_initialized) {
+        lv_style_init(&style_dot);
+        lv_style_set_bg_color(&style_dot, lv_palette_main(LV_PALETTE_AMBER));
+        lv_style_set_radius(&style_dot, LV_RADIUS_CIRCLE);
+        lv_style_set_border_width(&style_dot, 0);
+        style_initialized = true;
+    }
+
+    maze = &m;
+    maze->enableHints(true);
+
+    dot_count = dots < MAX_DOTS ? dots : MAX_DOTS;
+    for (int i = 0; i < dot_count; ++i) {
+        dot_objs[i] = lv_obj_create(parent);
+        lv_obj_remove_style_all(dot_objs[i]);
+        lv_obj_add_style(dot_objs[i], &style_dot, 0);
+        lv_obj_set_size(dot_objs[i], DOT_SIZE, DOT_SIZE);
+        lv_obj_clear_flag(dot_objs[i], LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+        lv_obj_add_flag(dot_objs[i], LV_OBJ_FLAG_HIDDEN);
+    }
+    last_cell = -2;
+}
+
+
+void MazeHint::detach(bool delete_objects) {
+    for (int i = 0; i < dot_count; ++i) {
+        if (delete_objects && dot_objs[i]) lv_obj_del(dot_objs[i]);
+        dot_objs[i] = nullptr;
+    }
+    dot_count = 0;
+    maze = nullptr;
+}
+
+
+void MazeHint::update(float ball_x, float ball_y) {
+    if (!maze || !visible) return;
+    int cell = maze->cellAtPixel(ball_x, ball_y);
+    if (cell == last_cell) return;
+    last_cell = cell;
+
+    // Follow the distance field downhill, one open neighbour per dot
+    int c = cell < 0 ? -1 : maze->hintNext(cell);
+    for (int i = 0; i < dot_count; ++i) {
+        if (c < 0) {
+            lv_obj_add_flag(dot_objs[i], LV_OBJ_FLAG_HIDDEN);
+            continue;
+        }
+        lv_point_t p = maze->cellCenterPixel(c);
+        lv_obj_set_pos(dot_objs[i], p.x - DOT_SIZE / 2, p.y - DOT_SIZE / 2);
+        lv_obj_clear_flag(dot_objs[i], LV_OBJ_FLAG_HIDDEN);
+        c = maze->hintNext(c);
+    }
+}
+
+
+void MazeHint::setVisible(bool on) {
+    visible = on;
+    last_cell = -2;
+    if (on) return;
+    for (int i = 0; i < dot_count; ++i) lv_obj_add_flag(dot_objs[i], LV_OBJ_FLAG_HIDDEN);
+}
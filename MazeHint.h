@@ -0,0 +1,51 @@
+#ifndef MAZE_HINT_H
+#define MAZE_HINT_H
+
+#include <lvgl.h>
+#include "maze.h"
+
+/**
+ * @class MazeHint
+ * @brief Breadcrumb trail from the ball's cell towards the exit.
+ *
+ * Reads the maze's exit distance field, so a lookup is a few byte compares. The dots are
+ * only moved when the ball enters another cell, nothing else on the screen is touched.
+ */
+class MazeHint {
+public:
+    static constexpr int MAX_DOTS = 8;
+
+    /**
+     * @brief Enables hints on maze and creates the (hidden) dots on parent
+     * @param maze generated maze, has to outlive the hint or be detached first
+     * @param parent screen the maze is drawn on
+     * @param dots number of cells shown ahead of the ball, up to MAX_DOTS
+     */
+    void attach(Maze& maze, lv_obj_t* parent, int dots = 4);
+
+    /**
+     * @brief Forgets the maze and deletes the dots. Skip delete_objects when the
+     * parent screen is already gone (its children went with it).
+     */
+    void detach(bool delete_objects = true);
+
+    /**
+     * @brief Call every frame, does nothing until the ball changes cell
+     */
+    void update(float ball_x, float ball_y);
+
+    void setVisible(bool on);
+    bool isAttached() const { return maze != nullptr; }
+
+private:
+    Maze* maze = nullptr;
+    lv_obj_t* dot_objs[MAX_DOTS] = {};
+    int dot_count = 0;
+    int last_cell = -2; ///< -2 forces a refresh, -1 is "outside the maze"
+    bool visible = true;
+
+    static lv_style_t style_dot;
+    static bool style_initialized;
+};
+
+#endif // MAZE_HINT_H
@@ -0,0 +1,125 @@
+#include "MazeId.h"
+#include "RectangularMaze.h"
+#include "CircularMaze.h"
+#include "MazeClock.h"
+#include "FixedMaze.h"
+#include "HexMaze.h"
+#include "TriangleMaze.h"
+#include "PolarTable.h"
+#include "MazeAnalyzer.h"
+
+static constexpr uint8_t MAZE_TYPE_COUNT = 5;
+static constexpr uint8_t MAZE_ALGORITHM_COUNT = 6;
+
+
+// Sizes the geometry can be built from: at least one cell and a non-zero cell size. Ring 0 of
+// the circular mazes is the open center, so they need two rings for a single ring of cells.
+// Adaptive rings keep doubling their sectors, from 162 to 177 rings on (by sector count) that
+// is more cells than the 16 bit ring starts and distances hold.
+static bool dimsValid(const MazeId& id) {
+    switch (id.type) {
+        case MazeType::Rectangular:
+        case MazeType::Hex:
+        case MazeType::Triangle:
+            return id.dims[0] > 0 && id.dims[1] > 0 && id.dims[2] > 0;
+        case MazeType::Circular:
+            return id.dims[0] >= 2 && id.dims[1] > 0 && id.dims[2] > 0
+                && PolarTable::cellCount(id.dims[0], id.dims[1], id.dims[3] != 0) <= MazeAnalyzer::MAX_CELLS;
+        case MazeType::Clock:
+            return id.dims[0] >= 2 && id.dims[1] > 0;
+    }
+    return false;
+}
+
+
+void MazeId::pack(uint8_t* out) const {
+    out[0] = (uint8_t)(((uint8_t)type << 4) | ((uint8_t)exit_placement << 3) | (uint8_t)algorithm);
+    for (int i = 0; i < 4; ++i) out[1 + i] = dims[i];
+    for (int i = 0; i < 4; ++i) out[5 + i] = (uint8_t)(seed >> (8 * i));
+}
+
+
+bool MazeId::unpack(const uint8_t* in, MazeId& out) {
+    uint8_t type = in[0] >> 4;
+    uint8_t algorithm = in[0] & 0x07;
+    if (type >= MAZE_TYPE_COUNT || algorithm >= MAZE_ALGORITHM_COUNT) return false;
+
+    out.type = (MazeType)type;
+    out.algorithm = (MazeAlgorithm)algorithm;
+    out.exit_placement = (ExitPlacement)((in[0] >> 3) & 1);
+    for (int i = 0; i < 4; ++i) out.dims[i] = in[1 + i];
+    out.seed = 0;
+    for (int i = 0; i < 4; ++i) out.seed |= (uint32_t)in[5 + i] << (8 * i);
+    return dimsValid(out);
+}
+
+
+void MazeId::toString(char* buf) const {
+    static const char hex[] = "0123456789ABCDEF";
+    uint8_t packed[PACKED_SIZE];
+    pack(packed);
+    for (size_t i = 0; i < PACKED_SIZE; ++i) {
+        buf[2 * i]     = hex[packed[i] >> 4];
+        buf[2 * i + 1] = hex[packed[i] & 0x0F];
+    }
+    buf[2 * PACKED_SIZE] = '\0';
+}
+
+
+bool MazeId::fromString(const char* str, MazeId& out) {
+    uint8_t packed[PACKED_SIZE];
+    for (size_t i = 0; i < 2 * PACKED_SIZE; ++i) {
+        char ch = str[i];
+        uint8_t v;
+        if (ch >= '0' && ch <= '9')      v = ch - '0';
+        else if (ch >= 'A' && ch <= 'F') v = ch - 'A' + 10;
+        else if (ch >= 'a' && ch <= 'f') v = ch - 'a' + 10;
+        else return false; // also catches a string that ends early
+        if (i & 1) packed[i / 2] |= v;
+        else       packed[i / 2] = v << 4;
+    }
+    if (str[2 * PACKED_SIZE] != '\0') return false;
+    return unpack(packed, out);
+}
+
+
+Maze* createMaze(const MazeId& id) {
+    if (!dimsValid(id)) return nullptr;
+
+    Maze* maze = nullptr;
+    switch (id.type) {
+        case MazeType::Rectangular:
+#if MAZE_FIXED_GEOMETRY
+            if (id.dims[0] == 10 && id.dims[1] == 10 && id.dims[2] == 16 && id.dims[3] == 40) {
+                maze = new ShippingRectangularMaze();
+                break;
+            }
+#endif
+            maze = new RectangularMaze(id.dims[0], id.dims[1], id.dims[2], id.dims[3]);
+            break;
+        case MazeType::Circular:
+#if MAZE_FIXED_GEOMETRY
+            if (id.dims[0] == 10 && id.dims[1] == 16 && id.dims[2] == 11 && id.dims[3] == 0) {
+                maze = new ShippingCircularMaze();
+                break;
+            }
+#endif
+            maze = new CircularMaze(id.dims[0], id.dims[1], id.dims[2], /*adaptive=*/id.dims[3] != 0);
+            break;
+        case MazeType::Clock:
+            maze = new MazeClock(id.dims[0], id.dims[1]);
+            break;
+        case MazeType::Hex:
+            maze = new HexMaze(id.dims[0], id.dims[1], id.dims[2]);
+            break;
+        case MazeType::Triangle:
+            maze = new TriangleMaze(id.dims[0], id.dims[1], id.dims[2]);
+            break;
+    }
+    if (maze) {
+        maze->setAlgorithm(id.algorithm);
+        maze->setSeed(id.seed);
+        maze->setExitPlacement(id.exit_placement);
+    }
+    return maze;
+}
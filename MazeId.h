@@ -0,0 +1,67 @@
+#ifndef MAZE_ID_H
+#define MAZE_ID_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "MazeGenerator.h"
+
+class Maze;
+
+enum class MazeType : uint8_t { Rectangular, Circular, Clock, Hex, Triangle };
+
+/**
+ * @brief Where the exit goes: mirrored from the spawn before carving, or on the perimeter
+ * cell with the longest path from the spawn once the maze is carved
+ */
+enum class ExitPlacement : uint8_t { Mirrored, Farthest };
+
+/**
+ * @struct MazeId
+ * @brief Everything needed to rebuild a maze bit for bit: type, dimensions, algorithm and seed.
+ *
+ * Packs into PACKED_SIZE bytes (or a short hex string) so a maze can be shared or replayed
+ * without storing its walls.
+ */
+struct MazeId {
+    static constexpr size_t PACKED_SIZE = 9;
+    static constexpr size_t STRING_SIZE = PACKED_SIZE * 2 + 1; // hex digits + terminator
+
+    MazeType type = MazeType::Rectangular;
+    MazeAlgorithm algorithm = MazeAlgorithm::Backtracker;
+    ExitPlacement exit_placement = ExitPlacement::Mirrored;
+    /// Type specific sizes: Rectangular {cols, rows, cell_size, offset},
+    /// Circular {rings, sectors, spacing, adaptive}, Clock {rings, spacing, 0, 0},
+    /// Hex {cols, rows, size, 0}, Triangle {cols, rows, side, 0}
+    uint8_t dims[4] = {0, 0, 0, 0};
+    uint32_t seed = 0;
+
+    /**
+     * @brief Writes the id as PACKED_SIZE bytes: type << 4 | farthest exit << 3 | algorithm, dims, little endian seed
+     */
+    void pack(uint8_t* out) const;
+
+    /**
+     * @brief Reads an id written by pack(), returns false if type or algorithm is unknown or
+     * the dimensions build no maze (a zero count or cell size, fewer than two rings)
+     */
+    static bool unpack(const uint8_t* in, MazeId& out);
+
+    /**
+     * @brief Writes the packed id as upper case hex into buf (at least STRING_SIZE bytes)
+     */
+    void toString(char* buf) const;
+
+    /**
+     * @brief Parses a string written by toString(), returns false on malformed input
+     */
+    static bool fromString(const char* str, MazeId& out);
+};
+
+/**
+ * @brief Allocates the maze described by id. The maze is not generated yet, generate() is
+ * reproducible once the seed and algorithm from the id are applied (done here).
+ * Returns nullptr for dimensions unpack() would reject.
+ */
+Maze* createMaze(const MazeId& id);
+
+#endif // MAZE_ID_H
@@ -0,0 +1,57 @@
+#ifndef MAZE_RANDOM_H
+#define MAZE_RANDOM_H
+
+#include <stdint.h>
+
+/**
+ * @class MazeRandom
+ * @brief Small seedable PRNG (xoshiro128**) used for everything that shapes a maze.
+ *
+ * Only 32-bit integer operations are involved, so a seed gives the same sequence on every
+ * board and on the host, unlike Arduino random() whose generator differs between cores.
+ */
+class MazeRandom {
+public:
+    explicit MazeRandom(uint32_t seed = 0) { setSeed(seed); }
+
+    /**
+     * @brief Restarts the sequence, state is expanded from the seed with splitmix32
+     */
+    void setSeed(uint32_t seed) {
+        for (int i = 0; i < 4; ++i) {
+            seed += 0x9E3779B9u;
+            uint32_t z = seed;
+            z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+            z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+            s[i] = z ^ (z >> 16);
+        }
+    }
+
+    uint32_t next() {
+        const uint32_t result = rotl(s[1] * 5u, 7) * 9u;
+        const uint32_t t = s[1] << 9;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 11);
+        return result;
+    }
+
+    /**
+     * @brief Uniform-ish integer in [0, n) without a division (multiply-shift range reduction)
+     */
+    uint32_t below(uint32_t n) {
+        return (uint32_t)(((uint64_t)next() * n) >> 32);
+    }
+
+    bool coin() { return next() >> 31; }
+
+private:
+    uint32_t s[4];
+
+    static uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+};
+
+#endif // MAZE_RANDOM_H
@@ -0,0 +1,97 @@
+#include "MazeTopology.h"
+
+// Out of line for north_slot.push_back(), which takes a reference (pre C++17 cores)
+constexpr uint8_t MazeTopology::NO_SLOT;
+
+void MazeTopology::clear(int cells_hint, int slots_hint) {
+    offsets.clear();
+    adj.clear();
+    slot_port.clear();
+    wall_mask.clear();
+    ports.clear();
+    north_slot.clear();
+    row_starts.clear();
+
+    offsets.reserve(cells_hint + 1);
+    adj.reserve(slots_hint);
+    slot_port.reserve(slots_hint);
+    wall_mask.reserve(cells_hint);
+    ports.reserve(cells_hint);
+    north_slot.reserve(cells_hint);
+    offsets.push_back(0);
+}
+
+
+int MazeTopology::addCell(uint8_t port_count) {
+    offsets.push_back(offsets.back());
+    ports.push_back(port_count);
+    wall_mask.push_back((uint8_t)((1u << port_count) - 1));
+    north_slot.push_back(NO_SLOT);
+    return cellCount() - 1;
+}
+
+
+void MazeTopology::addNeighbor(int other, uint8_t port, bool north) {
+    if (north) north_slot.back() = (uint8_t)(offsets.back() - offsets[offsets.size() - 2]);
+    adj.push_back((uint16_t)other);
+    slot_port.push_back(port);
+    ++offsets.back();
+}
+
+
+void MazeTopology::raiseAllWalls() {
+    for (size_t c = 0; c < ports.size(); ++c) wall_mask[c] = (uint8_t)((1u << ports[c]) - 1);
+}
+
+
+int MazeTopology::neighborAt(int cell, int port) const {
+    for (uint32_t s = offsets[cell]; s < offsets[cell + 1]; ++s) {
+        if (slot_port[s] == port) return adj[s];
+    }
+    return -1;
+}
+
+
+size_t MazeTopology::bytes() const {
+    return offsets.capacity() * sizeof(uint32_t) + (adj.capacity() + row_starts.capacity()) * sizeof(uint16_t)
+         + slot_port.capacity() + wall_mask.capacity() + ports.capacity() + north_slot.capacity();
+}
+
+
+int MazeTopology::neighbors(int cell, int* out) const {
+    int n = 0;
+    for (uint32_t s = offsets[cell]; s < offsets[cell + 1]; ++s) out[n++] = adj[s];
+    return n;
+}
+
+
+int MazeTopology::openNeighbors(int cell, int* out) const {
+    const uint8_t w = wall_mask[cell];
+    int n = 0;
+    for (uint32_t s = offsets[cell]; s < offsets[cell + 1]; ++s) {
+        if (!(w & (1u << slot_port[s]))) out[n++] = adj[s];
+    }
+    return n;
+}
+
+
+int MazeTopology::northOf(int cell) const {
+    uint8_t s = north_slot[cell];
+    return s == NO_SLOT ? -1 : adj[offsets[cell] + s];
+}
+
+
+void MazeTopology::clearWall(int cell, int other) {
+    for (uint32_t s = offsets[cell]; s < offsets[cell + 1]; ++s) {
+        if (adj[s] == other) {
+            wall_mask[cell] &= ~(1u << slot_port[s]);
+            return;
+        }
+    }
+}
+
+
+void MazeTopology::link(int a, int b) {
+    clearWall(a, b);
+    clearWall(b, a);
+}
@@ -0,0 +1,92 @@
+#ifndef MAZE_TOPOLOGY_H
+#define MAZE_TOPOLOGY_H
+
+#include <stdint.h>
+#include <vector>
+#include "MazeGenerator.h"
+
+/**
+ * @class MazeTopology
+ * @brief Any cell graph in compressed sparse row (CSR) form, usable by MazeGenerator and MazeAnalyzer.
+ *
+ * The neighbours of cell c are adj[offsets[c] .. offsets[c + 1]). Every cell has up to
+ * MAX_PORTS walls ("ports"), kept as one bit mask per cell like the other mazes, and every
+ * adjacency slot remembers which port it goes through. Ports without a slot are border walls.
+ *
+ * Cells are added row by row: beginRow(), then addCell() followed by addNeighbor() for each
+ * of its neighbours.
+ */
+class MazeTopology : public MazeGrid {
+public:
+    static constexpr int MAX_PORTS = 8;
+
+    /**
+     * @brief Drops all cells, the hints size the buffers up front
+     */
+    void clear(int cells_hint = 0, int slots_hint = 0);
+
+    /**
+     * @brief Starts a new row, the next added cell is its first
+     */
+    void beginRow() { row_starts.push_back((uint16_t)cellCount()); }
+
+    /**
+     * @brief Adds a cell with ports walls, all up
+     * @return index of the new cell
+     */
+    int addCell(uint8_t ports);
+
+    /**
+     * @brief Adds a neighbour of the last added cell
+     * @param other neighbour cell index (may not be added yet)
+     * @param port wall of the last added cell that is shared with other
+     * @param north other is the cell used by row based algorithms as "north"
+     */
+    void addNeighbor(int other, uint8_t port, bool north = false);
+
+    /**
+     * @brief Puts every wall back up
+     */
+    void raiseAllWalls();
+
+    uint8_t walls(int cell) const { return wall_mask[cell]; }
+    uint8_t portCount(int cell) const { return ports[cell]; }
+
+    /**
+     * @brief Cell behind port of cell, -1 for a border wall
+     */
+    int neighborAt(int cell, int port) const;
+
+    /**
+     * @brief Cell has at least one border wall
+     */
+    bool onBorder(int cell) const { return offsets[cell + 1] - offsets[cell] < ports[cell]; }
+
+    size_t bytes() const;
+
+    // MazeGrid
+    int cellCount() const override { return (int)ports.size(); }
+    int rowCount() const override { return (int)row_starts.size(); }
+    int rowStart(int row) const override { return row < rowCount() ? row_starts[row] : cellCount(); }
+    int neighbors(int cell, int* out) const override;
+    int openNeighbors(int cell, int* out) const override;
+    int northOf(int cell) const override;
+    void link(int a, int b) override;
+
+private:
+    // Slots run to about six per cell, past 16 bit for grids a MazeId can describe (255 x 255
+    // hex is 389k), the cells themselves stay under 65536
+    std::vector<uint32_t> offsets;    ///< cellCount() + 1 entries
+    std::vector<uint16_t> adj;        ///< neighbour per slot
+    std::vector<uint8_t> slot_port;   ///< wall of the cell behind each slot
+    std::vector<uint8_t> wall_mask;   ///< one bit per port, set = wall up
+    std::vector<uint8_t> ports;       ///< walls per cell
+    std::vector<uint8_t> north_slot;  ///< slot (relative to offsets[cell]) of the north neighbour, NO_SLOT if none
+    std::vector<uint16_t> row_starts;
+
+    static constexpr uint8_t NO_SLOT = 0xFF;
+
+    void clearWall(int cell, int other);
+};
+
+#endif // MAZE_TOPOLOGY_H
@@ -0,0 +1,119 @@
+#ifndef MOCK_IMU_BUS_H
+#define MOCK_IMU_BUS_H
+
+#include <string.h>
+#include "ImuBus.h"
+#include "FifoImuSource.h"
+
+/**
+ * @class MockImuBus
+ * @brief An LSM6DS3 at register level for host builds: a register file and a FIFO the test
+ * fills with pushSample(), with the transaction and byte counts of ImuBus.
+ *
+ * Reads of FIFO_STATUS1..4 report the words queued and where the next one is in the gyro /
+ * accelerometer pattern, reads of FIFO_DATA_OUT pop words and wrap from _H back to _L like
+ * the sensor, bypass mode written to FIFO_CTRL5 empties the FIFO. More than FIFO_WORDS words
+ * sets the overrun flag and drops the oldest, as continuous mode does.
+ */
+class MockImuBus : public ImuBus {
+public:
+    static constexpr int FIFO_WORDS = 2048; // the 4 kB of the LSM6DS3TR-C
+
+    MockImuBus() {
+        memset(regs, 0, sizeof(regs));
+        regs[FifoImuSource::WHO_AM_I] = 0x69;
+    }
+
+    /**
+     * @brief Queues one sample as the sensor would, raw LSB values
+     */
+    void pushSample(const int16_t gyro[3], const int16_t accel[3]) {
+        for (int k = 0; k < 3; ++k) push(gyro[k]);
+        for (int k = 0; k < 3; ++k) push(accel[k]);
+    }
+
+    int queuedWords() const { return words; }
+    uint8_t reg(uint8_t r) const { return regs[r]; }
+
+    // Makes the next transactions fail, as a sensor that stopped answering
+    void setOffline(bool off) { offline = off; }
+
+    size_t maxRead() const override { return max_read; }
+    void setMaxRead(size_t n) { max_read = n; }
+
+protected:
+    bool transferRead(uint8_t reg, uint8_t* buf, size_t len) override {
+        if (offline) return false;
+        bool high = false;
+        for (size_t i = 0; i < len; ++i) {
+            const uint8_t r = reg;
+            if (r == FifoImuSource::FIFO_DATA_OUT_L || r == FifoImuSource::FIFO_DATA_OUT_L + 1) {
+                buf[i] = dataByte(high);
+                high = !high;
+                reg = high ? FifoImuSource::FIFO_DATA_OUT_L + 1 : FifoImuSource::FIFO_DATA_OUT_L;
+                continue;
+            }
+            buf[i] = statusOr(r);
+            ++reg;
+        }
+        return true;
+    }
+
+    bool transferWrite(uint8_t reg, uint8_t value) override {
+        if (offline) return false;
+        regs[reg] = value;
+        if (reg == FifoImuSource::FIFO_CTRL5 && (value & 0x07) == 0) {
+            head = words = 0;
+            pattern = 0;
+            overrun = false;
+        }
+        return true;
+    }
+
+private:
+    uint8_t regs[128];
+    int16_t fifo[FIFO_WORDS];
+    int head = 0;          ///< oldest word
+    int words = 0;
+    int pattern = 0;       ///< position of the oldest word in gyro x y z, accel x y z
+    bool overrun = false;
+    int16_t current = 0;   ///< word being read, its high byte comes next
+    bool offline = false;
+    size_t max_read = IMU_I2C_BURST_BYTES;
+
+    void push(int16_t w) {
+        if (words == FIFO_WORDS) {
+            head = (head + 1) % FIFO_WORDS;
+            pattern = (pattern + 1) % 6;
+            --words;
+            overrun = true;
+        }
+        fifo[(head + words) % FIFO_WORDS] = w;
+        ++words;
+    }
+
+    uint8_t dataByte(bool high) {
+        if (high) return (uint8_t)((uint16_t)current >> 8);
+        current = 0;
+        if (words > 0) {
+            current = fifo[head];
+            head = (head + 1) % FIFO_WORDS;
+            pattern = (pattern + 1) % 6;
+            --words;
+        }
+        return (uint8_t)current;
+    }
+
+    uint8_t statusOr(uint8_t r) const {
+        switch (r) {
+            case FifoImuSource::FIFO_STATUS1: return (uint8_t)words;
+            case FifoImuSource::FIFO_STATUS1 + 1:
+                return (uint8_t)(((words >> 8) & 0x0F) | (overrun ? 0x40 : 0) | (words == 0 ? 0x10 : 0));
+            case FifoImuSource::FIFO_STATUS1 + 2: return (uint8_t)pattern;
+            case FifoImuSource::FIFO_STATUS1 + 3: return 0;
+            default: return regs[r & 0x7F];
+        }
+    }
+};
+
+#endif // MOCK_IMU_BUS_H
@@ -0,0 +1,40 @@
+#include "PhysicsClock.h"
+
+
+void PhysicsClock::setRate(uint16_t hz) {
+    if (hz == 0) hz = 1;
+    physics_hz = hz;
+    step_us = 1000000UL / hz;
+    step_dt = step_us / 1000000.0f;
+    // powf once here instead of every step
+    step_friction = BallScalar(powf(FRICTION, step_dt));
+#if MAZE_FIXED_POINT
+    step_gravity = BallScalar(GRAVITY * step_dt);
+    step_scale = BallScalar(step_dt * SCALE_FACTOR);
+#endif
+}
+
+
+int PhysicsClock::advance(uint32_t now_us) {
+    accumulator_us += now_us - last_update_us;
+    last_update_us = now_us;
+
+    int steps = accumulator_us / step_us;
+    if (steps > MAX_STEPS_PER_FRAME) {
+        // a long stall (drawing a level, a slow flush), don't try to catch up
+        steps = MAX_STEPS_PER_FRAME;
+        accumulator_us = 0;
+    } else {
+        accumulator_us -= steps * step_us;
+    }
+    return steps;
+}
+
+
+BallScalar PhysicsClock::alpha() const {
+#if MAZE_FIXED_POINT
+    return BallScalar::fromRaw(step_us ? (int32_t)((uint64_t)accumulator_us * BallScalar::ONE / step_us) : BallScalar::ONE);
+#else
+    return step_us ? (float)accumulator_us / step_us : 1.0f;
+#endif
+}
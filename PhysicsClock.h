@@ -0,0 +1,100 @@
+#ifndef PHYSICS_CLOCK_H
+#define PHYSICS_CLOCK_H
+
+#include <stdint.h>
+#include "FixedPoint.h"
+
+// Default physics steps per second, each one is a collision query too
+#ifndef BALL_PHYSICS_HZ
+#define BALL_PHYSICS_HZ 240
+#endif
+
+/**
+ * @class PhysicsClock
+ * @brief Fixed step timing and the per step constants of the ball physics, shared by Ball and
+ * BallSwarm.
+ *
+ * advance() turns the wall time since the last frame into a number of steps of 1 / rate
+ * seconds, alpha() tells how far the clock is into the next one so drawing can interpolate.
+ */
+class PhysicsClock {
+public:
+    // Tuning, independent of the physics rate
+    static constexpr float GRAVITY = 5.0f;        // velocity gained per second per degree of tilt
+    static constexpr float FRICTION = 0.133f;     // fraction of the velocity left after one second
+    static constexpr float SCALE_FACTOR = 10.0f;  // pixels per second per unit of velocity
+    static constexpr int MAX_STEPS_PER_FRAME = 8; // time beyond this is dropped, the ball slows down instead of the loop
+
+    explicit PhysicsClock(uint16_t hz = BALL_PHYSICS_HZ) { setRate(hz); }
+
+    /**
+     * @brief Sets the fixed step rate, more steps cost more collision queries per second
+     */
+    void setRate(uint16_t hz);
+    uint16_t rate() const { return physics_hz; }
+
+    /**
+     * @brief Starts counting from now_us, nothing is owed yet
+     */
+    void restart(uint32_t now_us) {
+        last_update_us = now_us;
+        accumulator_us = 0;
+    }
+
+    /**
+     * @brief Adds the time since the last call to the step accumulator
+     * @param now_us current time from micros()
+     * @return number of fixed steps to run this frame, at most MAX_STEPS_PER_FRAME
+     */
+    int advance(uint32_t now_us);
+
+    /**
+     * @brief Fraction of the next step the clock is already into, 0..1
+     */
+    BallScalar alpha() const;
+
+    uint32_t lastUpdateUs() const { return last_update_us; }
+
+    /**
+     * @brief Velocity change over one step for a tilt in degrees
+     */
+    BallScalar tiltAccel(float tilt) const {
+#if MAZE_FIXED_POINT
+        return -(BallScalar(tilt) * step_gravity);
+#else
+        return -tilt * GRAVITY * step_dt;
+#endif
+    }
+
+    /**
+     * @brief Factor the velocity is multiplied with every step, FRICTION ^ step time
+     */
+    BallScalar friction() const { return step_friction; }
+
+    /**
+     * @brief Pixels moved over one step at velocity v
+     */
+    BallScalar stepDelta(BallScalar v) const {
+#if MAZE_FIXED_POINT
+        return v * step_scale;
+#else
+        return v * step_dt * SCALE_FACTOR;
+#endif
+    }
+
+private:
+    uint32_t last_update_us = 0;
+    uint32_t accumulator_us = 0;   // wall time not yet simulated
+
+    // Fixed step, derived from the rate by setRate
+    uint16_t physics_hz = 0;
+    uint32_t step_us = 0;
+    float step_dt = 0.0f;
+    BallScalar step_friction = BallScalar(1.0f); // FRICTION ^ step_dt
+#if MAZE_FIXED_POINT
+    BallScalar step_gravity;       // GRAVITY * step_dt, velocity per degree of tilt per step
+    BallScalar step_scale;         // step_dt * SCALE_FACTOR, pixels per unit of velocity per step
+#endif
+};
+
+#endif // PHYSICS_CLOCK_H
@@ -0,0 +1,105 @@
+#include "PolarTable.h"
+#include <math.h>
+
+PolarTable* PolarTable::first = nullptr;
+
+
+// Adaptive layouts double the sectors at ring once a cell of n sectors, measured along its
+// middle arc, would be over two ring spacings wide (2*pi*(r + 0.5)*spacing / n > 2*spacing)
+static bool doublesAt(int ring, long n) {
+    return ring > 1 && 2.0f * M_PI * (ring + 0.5f) / n > 2.0f;
+}
+
+
+const PolarTable* PolarTable::acquire(int rings, int sectors, bool adaptive) {
+    for (PolarTable* t = first; t; t = t->next) {
+        if (t->RINGS == rings && t->SECTORS == sectors && t->ADAPTIVE == adaptive) {
+            t->refs++;
+            return t;
+        }
+    }
+    PolarTable* t = new PolarTable(rings, sectors, adaptive);
+    t->refs = 1;
+    t->next = first;
+    first = t;
+    return t;
+}
+
+
+void PolarTable::release(const PolarTable* table) {
+    for (PolarTable** link = &first; *link; link = &(*link)->next) {
+        PolarTable* t = *link;
+        if (t != table) continue;
+        if (--t->refs == 0) {
+            *link = t->next;
+            delete t;
+        }
+        return;
+    }
+}
+
+
+long PolarTable::cellCount(int rings, int sectors, bool adaptive) {
+    long cells = 0;
+    long n = sectors;
+    for (int r = 0; r < rings; ++r) {
+        if (adaptive && doublesAt(r, n)) n *= 2;
+        cells += n;
+    }
+    return cells;
+}
+
+
+PolarTable::PolarTable(int rings, int sectors, bool adaptive) {
+    RINGS = rings;
+    SECTORS = sectors;
+    ADAPTIVE = adaptive;
+
+    // Sector count per ring
+    ring_sectors.resize(RINGS);
+    ring_start.resize(RINGS + 1);
+    int n = SECTORS;
+    ring_start[0] = 0;
+    for (int r = 0; r < RINGS; ++r) {
+        if (ADAPTIVE && doublesAt(r, n)) {
+            n *= 2;
+            split_arcs += ring_sectors[r - 1];
+        }
+        ring_sectors[r] = n;
+        ring_start[r + 1] = ring_start[r] + n;
+    }
+
+    // Directions for every distinct sector count, worked out in double once so that
+    // spokes on the axes come out exactly axis aligned
+    auto add = [this](double a) {
+        double x = cos(a), y = sin(a);
+        if (fabs(x) < 1e-9) x = 0.0;
+        if (fabs(y) < 1e-9) y = 0.0;
+        dirs.push_back({ (float)x, (float)y });
+    };
+    int total = 0;
+    for (int r = 0; r < RINGS; ++r) {
+        if (r == 0 || ring_sectors[r] != ring_sectors[r - 1]) total += ring_sectors[r] * (ARC_STEPS + 1) + 1;
+    }
+    dirs.reserve(total);
+    arc_offset.resize(RINGS);
+    mid_offset.resize(RINGS);
+    for (int r = 0; r < RINGS; ++r) {
+        if (r > 0 && ring_sectors[r] == ring_sectors[r - 1]) {
+            arc_offset[r] = arc_offset[r - 1];
+            mid_offset[r] = mid_offset[r - 1];
+            continue;
+        }
+        const int count = ring_sectors[r];
+        const double step = 2.0 * M_PI / count;
+        arc_offset[r] = (uint16_t)dirs.size();
+        for (int k = 0; k < count * ARC_STEPS; ++k) add(k * step / ARC_STEPS);
+        dirs.push_back(dirs[arc_offset[r]]);
+        mid_offset[r] = (uint16_t)dirs.size();
+        for (int s = 0; s < count; ++s) add((s + 0.5) * step);
+    }
+#if MAZE_FIXED_POINT
+    ball_dirs.reserve(dirs.size());
+    for (const PolarDir& d : dirs) ball_dirs.push_back({ BallScalar(d.x), BallScalar(d.y) });
+#endif
+}
@@ -0,0 +1,154 @@
+#ifndef POLAR_TABLE_H
+#define POLAR_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "FixedPoint.h"
+
+/**
+ * @brief Unit vector pointing away from the maze center
+ */
+struct PolarDir {
+    float x, y;
+};
+
+/**
+ * @brief PolarDir in the ball's format, read by the substep collision kernel
+ */
+#if MAZE_FIXED_POINT
+struct BallDir {
+    BallScalar x, y;
+};
+#else
+typedef PolarDir BallDir;
+#endif
+
+/**
+ * @class PolarTable
+ * @brief Ring layout and every direction a polar maze needs, computed once per layout.
+ *
+ * Holds the sector count and first mask index of each ring, and for every sector the unit
+ * vectors of its boundary spoke, its middle and the points its arcs are drawn through.
+ * Directions don't depend on the ring spacing, so pixels are a multiply away and one table
+ * serves every maze with the same rings / sectors / adaptive settings. Drawing, collision and
+ * the clock face read from here instead of calling cos / sin / atan2.
+ */
+class PolarTable {
+public:
+    static constexpr int ARC_STEPS = 5; ///< line pieces an arc is drawn with, per sector
+
+    /**
+     * @brief Table for a layout, built on first use and shared until the last user releases it
+     * @param rings rings including the hub
+     * @param sectors sectors of every ring, or of the innermost ring if adaptive
+     * @param adaptive double the sectors outwards to keep cells about equally wide
+     */
+    static const PolarTable* acquire(int rings, int sectors, bool adaptive);
+    static void release(const PolarTable* table);
+
+    /**
+     * @brief Cells of a layout (hub ring included) without building it. Ring starts are 16 bit,
+     * layouts over MazeAnalyzer::MAX_CELLS are rejected by MazeId before they get here.
+     */
+    static long cellCount(int rings, int sectors, bool adaptive);
+
+    int rings() const { return RINGS; }
+    int ringSectors(int ring) const { return ring_sectors[ring]; }
+    int ringStart(int ring) const { return ring_start[ring]; }
+    const uint16_t* ringSectorsTable() const { return ring_sectors.data(); }
+    const uint16_t* ringStartTable() const { return ring_start.data(); }
+    /// arcs stored as two halves, ring + 1 has twice the sectors
+    int splitArcs() const { return split_arcs; }
+
+    /**
+     * @brief Direction of the spoke at the start (counter clockwise side) of sector s of ring
+     */
+    const PolarDir& boundary(int ring, int s) const { return dirs[arc_offset[ring] + s * ARC_STEPS]; }
+
+    /**
+     * @brief Point k of the arcs of ring, sector s spans k = s * ARC_STEPS .. (s + 1) * ARC_STEPS.
+     * The last sector ends on an extra copy of direction 0, so arcs never wrap.
+     */
+    const PolarDir& arcPoint(int ring, int k) const { return dirs[arc_offset[ring] + k]; }
+
+    /**
+     * @brief Direction through the middle of sector s of ring
+     */
+    const PolarDir& middle(int ring, int s) const { return dirs[mid_offset[ring] + s]; }
+
+    /**
+     * @brief Sector of ring containing the direction (dx, dy) from the center
+     */
+    int sectorOf(int ring, float dx, float dy) const {
+        return sectorIn(&dirs[arc_offset[ring]], ring_sectors[ring], dx, dy);
+    }
+
+    /**
+     * @brief boundary(), middle() and sectorOf() in the ball's format, the same table in float builds
+     */
+    const BallDir& ballBoundary(int ring, int s) const { return ballDirs()[arc_offset[ring] + s * ARC_STEPS]; }
+    const BallDir& ballArcPoint(int ring, int k) const { return ballDirs()[arc_offset[ring] + k]; }
+    const BallDir& ballMiddle(int ring, int s) const { return ballDirs()[mid_offset[ring] + s]; }
+    int ballSectorOf(int ring, BallScalar dx, BallScalar dy) const {
+        return sectorIn(&ballDirs()[arc_offset[ring]], ring_sectors[ring], dx, dy);
+    }
+
+    /**
+     * @brief Binary search over n boundaries (ARC_STEPS apart) with cross products, no atan2.
+     * Boundary s comes at or before the point if it lies in an earlier half turn, or in the same
+     * half turn with the point counter clockwise from it.
+     */
+    template <typename Dir, typename Scalar>
+    static int sectorIn(const Dir* arc_dirs, int n, Scalar dx, Scalar dy) {
+        const Scalar zero = Scalar(0.0f);
+        const bool lower = dy < zero || (dy == zero && dx < zero);
+        int lo = 0, hi = n; // boundary 0 is at angle 0, before everything
+        while (hi - lo > 1) {
+            const int mid = (lo + hi) >> 1;
+            const Dir& d = arc_dirs[mid * ARC_STEPS];
+            const bool d_lower = d.y < zero || (d.y == zero && d.x < zero);
+            const bool before = d_lower != lower ? lower : (d.x * dy - d.y * dx >= zero);
+            if (before) lo = mid; else hi = mid;
+        }
+        return lo;
+    }
+
+    /**
+     * @brief Bytes held by the table
+     */
+    size_t bytes() const {
+        return sizeof(PolarTable) + dirs.capacity() * sizeof(PolarDir) +
+#if MAZE_FIXED_POINT
+               ball_dirs.capacity() * sizeof(BallDir) +
+#endif
+               (ring_start.capacity() + ring_sectors.capacity() + arc_offset.capacity() + mid_offset.capacity()) * sizeof(uint16_t);
+    }
+
+private:
+    PolarTable(int rings, int sectors, bool adaptive);
+
+    int RINGS;
+    int SECTORS;
+    bool ADAPTIVE;
+    int split_arcs = 0;
+
+    std::vector<uint16_t> ring_start;   ///< first mask index of each ring, RINGS + 1 entries
+    std::vector<uint16_t> ring_sectors; ///< sectors in each ring
+    // rings with the same sector count share their directions
+    std::vector<uint16_t> arc_offset;   ///< index of arc point 0 of each ring in dirs
+    std::vector<uint16_t> mid_offset;   ///< index of the middle of sector 0 of each ring in dirs
+    std::vector<PolarDir> dirs;
+#if MAZE_FIXED_POINT
+    std::vector<BallDir> ball_dirs; ///< dirs converted once for the fixed point kernel
+    const BallDir* ballDirs() const { return ball_dirs.data(); }
+#else
+    const BallDir* ballDirs() const { return dirs.data(); }
+#endif
+
+    int refs = 0;
+    PolarTable* next = nullptr;
+    static PolarTable* first; ///< live tables
+};
+
+#endif // POLAR_TABLE_H
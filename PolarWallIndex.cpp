@@ -0,0 +1,162 @@
+#include "PolarWallIndex.h"
+#include "CircularMaze.h"
+#include <math.h>
+
+
+void PolarWallIndex::build(const PolarTable& t, const uint8_t* cell_walls, int ring_spacing, float center_x, float center_y) {
+    table = &t;
+    spacing = (float)ring_spacing;
+    cx = center_x;
+    cy = center_y;
+
+    // Same walls the kernel and the drawing see: outer arcs of rings 1.., spokes of rings 2..
+    walls.clear();
+    for (int ring = 1; ring < t.rings(); ++ring) {
+        const bool split = ring + 1 < t.rings() && t.ringSectors(ring + 1) != t.ringSectors(ring);
+        for (int s = 0; s < t.ringSectors(ring); ++s) {
+            const uint8_t m = cell_walls[t.ringStart(ring) + s];
+            if (ring > 1 && (m & SPOKE_CCW)) walls.push_back({ SPOKE, (uint8_t)ring, (uint16_t)s });
+            if (!split) {
+                if (m & ARC_OUT) walls.push_back({ ARC, (uint8_t)ring, (uint16_t)s });
+            } else if ((m & ARC_OUT) && (m & ARC_OUT_B)) {
+                walls.push_back({ ARC, (uint8_t)ring, (uint16_t)s });
+            } else if (m & ARC_OUT) {
+                walls.push_back({ ARC_FIRST_HALF, (uint8_t)ring, (uint16_t)s });
+            } else if (m & ARC_OUT_B) {
+                walls.push_back({ ARC_SECOND_HALF, (uint8_t)ring, (uint16_t)s });
+            }
+        }
+    }
+
+    // Grid over the square around the outer ring
+    const float extent = t.rings() * spacing + 1.0f;
+    origin_x = cx - extent;
+    origin_y = cy - extent;
+    cols = rows = (int)ceilf(2.0f * extent / BUCKET_PX);
+
+    // Two passes, count then fill, so the lists go in one flat array
+    bucket_start.assign(cols * rows + 1, 0);
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1) {
+            for (int b = 0; b < cols * rows; ++b) bucket_start[b + 1] += bucket_start[b];
+            bucket_walls.assign(bucket_start[cols * rows], 0);
+        }
+        std::vector<uint32_t> fill;
+        if (pass == 1) fill.assign(bucket_start.begin(), bucket_start.end() - 1);
+        for (size_t i = 0; i < walls.size(); ++i) {
+            float x0, y0, x1, y1;
+            wallBox(walls[i], x0, y0, x1, y1);
+            int c0, r0, c1, r1;
+            bucketRange(x0 - MAX_BALL_RADIUS, y0 - MAX_BALL_RADIUS, x1 + MAX_BALL_RADIUS, y1 + MAX_BALL_RADIUS, c0, r0, c1, r1);
+            for (int r = r0; r <= r1; ++r) {
+                for (int c = c0; c <= c1; ++c) {
+                    if (pass == 0) ++bucket_start[r * cols + c + 1];
+                    else bucket_walls[fill[r * cols + c]++] = (uint32_t)i;
+                }
+            }
+        }
+    }
+}
+
+
+void PolarWallIndex::bucketRange(float x0, float y0, float x1, float y1, int& c0, int& r0, int& c1, int& r1) const {
+    const float inv = 1.0f / BUCKET_PX;
+    c0 = (int)floorf((x0 - origin_x) * inv);
+    r0 = (int)floorf((y0 - origin_y) * inv);
+    c1 = (int)floorf((x1 - origin_x) * inv);
+    r1 = (int)floorf((y1 - origin_y) * inv);
+    if (c0 < 0) c0 = 0;
+    if (r0 < 0) r0 = 0;
+    if (c1 > cols - 1) c1 = cols - 1;
+    if (r1 > rows - 1) r1 = rows - 1;
+}
+
+
+void PolarWallIndex::wallBox(const Wall& w, float& x0, float& y0, float& x1, float& y1) const {
+    x0 = y0 = 1e9f;
+    x1 = y1 = -1e9f;
+    auto grow = [&](const PolarDir& d, float radius) {
+        const float x = cx + radius * d.x, y = cy + radius * d.y;
+        if (x < x0) x0 = x;
+        if (x > x1) x1 = x;
+        if (y < y0) y0 = y;
+        if (y > y1) y1 = y;
+    };
+    if (w.kind == SPOKE) {
+        const PolarDir& d = table->boundary(w.ring, w.sector);
+        grow(d, w.ring * spacing);
+        grow(d, (w.ring + 1) * spacing);
+        return;
+    }
+    // the arc's drawing points, a pixel of slack for the bulge between them
+    const float radius = (w.ring + 1) * spacing;
+    const int steps = PolarTable::ARC_STEPS;
+    for (int k = 0; k <= steps; ++k) grow(table->arcPoint(w.ring, w.sector * steps + k), radius);
+    x0 -= 1.0f; y0 -= 1.0f; x1 += 1.0f; y1 += 1.0f;
+}
+
+
+bool PolarWallIndex::resolve(const Wall& w, float& x, float& y, float& vx, float& vy, float br) const {
+    const float px = x - cx, py = y - cy;
+    float dx, dy; // from the closest wall point to the ball center
+
+    if (w.kind == SPOKE) {
+        const PolarDir& d = table->boundary(w.ring, w.sector);
+        const float r_in = w.ring * spacing;
+        float t = px * d.x + py * d.y;
+        if (t < r_in) t = r_in;
+        if (t > r_in + spacing) t = r_in + spacing;
+        dx = px - t * d.x;
+        dy = py - t * d.y;
+    } else {
+        const PolarDir* u0 = &table->boundary(w.ring, w.sector);
+        const PolarDir* u1 = &table->boundary(w.ring, w.sector + 1);
+        if (w.kind == ARC_FIRST_HALF) u1 = &table->middle(w.ring, w.sector);
+        if (w.kind == ARC_SECOND_HALF) u0 = &table->middle(w.ring, w.sector);
+        const float radius = (w.ring + 1) * spacing;
+        if (u0->x * py - u0->y * px >= 0.0f && px * u1->y - py * u1->x >= 0.0f) {
+            // within the arc's angles, the closest point is straight out from the center
+            const float rho = sqrtf(px*px + py*py);
+            if (fabsf(rho - radius) >= br || rho < 1e-6f) return false;
+            const float k = (rho - radius) / rho;
+            dx = px * k;
+            dy = py * k;
+        } else {
+            // past an end, the closest point is that end
+            const float ax = px - radius * u0->x, ay = py - radius * u0->y;
+            const float bx = px - radius * u1->x, by = py - radius * u1->y;
+            if (ax*ax + ay*ay < bx*bx + by*by) { dx = ax; dy = ay; }
+            else { dx = bx; dy = by; }
+        }
+    }
+
+    const float d2 = dx*dx + dy*dy;
+    if (d2 >= br*br || d2 < 1e-12f) return false;
+    const float d = sqrtf(d2);
+    const float nx = dx / d, ny = dy / d;
+    x += nx * (br - d);
+    y += ny * (br - d);
+
+    reflectOffWall(vx, vy, nx, ny);
+    return true;
+}
+
+
+bool PolarWallIndex::collide(float& x, float& y, float& vx, float& vy, float br) const {
+    if (!table) return false;
+    // every wall within MAX_BALL_RADIUS of the bucket is in its list
+    const float reach = br > MAX_BALL_RADIUS ? br : 0.0f;
+    int c0, r0, c1, r1;
+    bucketRange(x - reach, y - reach, x + reach, y + reach, c0, r0, c1, r1);
+    // a wall in two of these buckets is resolved twice, the second time it is already clear
+    bool touched = false;
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) {
+            const int b = r * cols + c;
+            for (uint32_t i = bucket_start[b]; i < bucket_start[b + 1]; ++i) {
+                touched |= resolve(walls[bucket_walls[i]], x, y, vx, vy, br);
+            }
+        }
+    }
+    return touched;
+}
@@ -0,0 +1,87 @@
+#ifndef POLAR_WALL_INDEX_H
+#define POLAR_WALL_INDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "PolarTable.h"
+#include "Ball.h"
+
+/**
+ * @class PolarWallIndex
+ * @brief Raised walls of a polar maze sorted into a uniform grid of square buckets.
+ *
+ * Every spoke and every arc (or arc half) that is up is one 4 byte entry, listed in each bucket
+ * its bounding box (grown by MAX_BALL_RADIUS) touches. A collision query looks only at the
+ * bucket under the ball, so walls of neighbouring cells (spoke ends at corners in particular)
+ * are seen as well, and the ball is never converted to ring / sector first. Built once per maze.
+ */
+class PolarWallIndex {
+public:
+    static constexpr int BUCKET_PX = 16;
+    // Walls are listed in every bucket within this distance, so a ball up to this radius only
+    // needs the bucket under its center. Bigger balls look at all buckets they cover.
+    static constexpr float MAX_BALL_RADIUS = 6.0f;
+
+    /**
+     * @brief Collects the raised walls
+     * @param cell_walls PolarWall masks, index = ringStart(ring) + sector (hub ring included)
+     */
+    void build(const PolarTable& table, const uint8_t* cell_walls, int spacing, float center_x, float center_y);
+
+    /**
+     * @brief Pushes the ball out of every wall it overlaps, damped reflection like the other kernels
+     * @param ball a Ball or a BallSwarm::Body
+     */
+    template <typename Body>
+    void collide(Body& ball) const {
+        collideBody(ball, [this](float& x, float& y, float& vx, float& vy, float br) {
+            return collide(x, y, vx, vy, br);
+        });
+    }
+
+    /**
+     * @brief The same on a ball's position, velocity and radius
+     * @return true if any of them changed
+     */
+    bool collide(float& x, float& y, float& vx, float& vy, float br) const;
+
+    int wallCount() const { return (int)walls.size(); }
+
+    /**
+     * @brief Bytes held by the index
+     */
+    size_t bytes() const {
+        return walls.capacity() * sizeof(Wall) + (bucket_start.capacity() + bucket_walls.capacity()) * sizeof(uint32_t);
+    }
+
+private:
+    enum Kind : uint8_t { SPOKE, ARC, ARC_FIRST_HALF, ARC_SECOND_HALF };
+
+    struct Wall {
+        uint8_t kind;
+        uint8_t ring;
+        uint16_t sector;
+    };
+
+    const PolarTable* table = nullptr;
+    float spacing = 1.0f;
+    float cx = 0.0f, cy = 0.0f;
+    float origin_x = 0.0f, origin_y = 0.0f; ///< top left of bucket (0, 0)
+    int cols = 0, rows = 0;
+
+    std::vector<Wall> walls;
+    // 32 bit: a big maze has more walls than cells, and each is listed in several buckets
+    std::vector<uint32_t> bucket_start; ///< cols * rows + 1 entries, into bucket_walls
+    std::vector<uint32_t> bucket_walls; ///< wall indices, bucket after bucket
+
+    /**
+     * @brief Bucket range covered by a box, clamped to the grid
+     */
+    void bucketRange(float x0, float y0, float x1, float y1, int& c0, int& r0, int& c1, int& r1) const;
+
+    void wallBox(const Wall& w, float& x0, float& y0, float& x1, float& y1) const;
+    bool resolve(const Wall& w, float& x, float& y, float& vx, float& vy, float br) const;
+};
+
+#endif // POLAR_WALL_INDEX_H
@@ -1,146 +1,235 @@
 #include "RectangularMaze.h"
 #include <Arduino.h>
 
-RectangularMaze::RectangularMaze(int cols, int rows, int cell_size, int offset) {
+RectangularMaze::RectangularMaze(int cols, int rows, int cell_size, int offset)
+    : RectangularMaze(cols, rows, cell_size, offset, nullptr) {}
+
+
+RectangularMaze::RectangularMaze(int cols, int rows, int cell_size, int offset, uint8_t* wall_storage) {
     COLS = cols;
     ROWS = rows;
     CELL_SIZE = cell_size;
     OFFSET = offset;
+    geometry = RectGeometry(COLS, ROWS, CELL_SIZE, OFFSET);
 
-    // Resize all wall and cell tracking vectors
-    horiz_walls.resize(ROWS + 1, std::vector<bool>(COLS));
-    vert_walls.resize(ROWS, std::vector<bool>(COLS + 1));
-    visited_cells.resize(ROWS, std::vector<bool>(COLS));
+    // One flat allocation for all walls, unless the caller brought its own
+    if (!wall_storage) {
+        owned_walls.resize(ROWS * COLS);
+        wall_storage = owned_walls.data();
+    }
+    cell_walls = wall_storage;
     int MAX_WALLS = (ROWS + 1) * COLS + ROWS * (COLS + 1);
 
-    // Resize the LVGL point buffer
-    wall_points.resize(MAX_WALLS);
+    // Every wall is a straight 2 point line, merged runs only ever need fewer
+    wall_runs.reserve(MAX_WALLS);
+    wall_layer.reserve(MAX_WALLS, 2 * MAX_WALLS);
+
+    analyzer.reserve(ROWS * COLS);
 }
 
 
 
-void RectangularMaze::generate() {
-    // Note the exclusive / inclusive less than symbols, this allows us to generate the outermost edges of the maze
-    for (int r = 0; r <= ROWS; ++r) {
-        for (int c = 0; c < COLS; ++c) horiz_walls[r][c] = true;
-    }
-    for (int r = 0; r < ROWS; ++r) {
-        for (int c = 0; c <= COLS; ++c) vert_walls[r][c] = true;
-    }
+void RectangularMaze::beginGenerate() {
+    rng.setSeed(seed);
 
-    // Clear the visited cells vector
-    for(auto& row : visited_cells) {
-        std::fill(row.begin(), row.end(), false);
-    }
+    // All four walls up in every cell, memset resets the table a word at a time
+    memset(cell_walls, WALL_N | WALL_S | WALL_W | WALL_E, ROWS * COLS);
 
     //get location of ball and exit
     placeExitAndSpawn();
 
-    carve(random(COLS), random(ROWS));
+    // Eller streams rows from the top, there is no start cell to draw
+    if (getAlgorithm() == MazeAlgorithm::Eller) {
+        eller.begin(COLS, ROWS, rng);
+        return;
+    }
+    generator.begin(*this, rng.below(ROWS) * COLS + rng.below(COLS), rng);
 }
 
 
 
-void RectangularMaze::draw(lv_obj_t* parent, bool animate) {
-    // This style is static, so it's initialized only once across all instances.
-    static lv_style_t style_wall;
-    static bool style_initialized = false;
-    if (!style_initialized) {
-        lv_style_init(&style_wall);
-        lv_style_set_line_width(&style_wall, 2);
-        lv_style_set_line_color(&style_wall, lv_color_white());
-        lv_style_set_line_rounded(&style_wall, true);
-        style_initialized = true;
+bool RectangularMaze::nextEllerRow() {
+    // rows come out in the same mask layout as cell_walls
+    if (!eller.nextRow()) return false;
+    memcpy(&cell_walls[eller.rowIndex() * COLS], eller.rowWalls(), COLS);
+    return true;
+}
+
+
+
+bool RectangularMaze::carveStep(uint32_t budget) {
+    if (getAlgorithm() != MazeAlgorithm::Eller) return Maze::carveStep(budget);
+    for (uint32_t spent = 0; spent < budget; spent += COLS) {
+        if (!nextEllerRow()) return true;
     }
+    return false;
+}
+
+
+
+MazeId RectangularMaze::getId() const {
+    MazeId id;
+    id.type = MazeType::Rectangular;
+    id.algorithm = getAlgorithm();
+    id.dims[0] = COLS;
+    id.dims[1] = ROWS;
+    id.dims[2] = CELL_SIZE;
+    id.dims[3] = OFFSET;
+    id.seed = seed;
+    id.exit_placement = exit_placement;
+    return id;
+}
+
+
+
+void RectangularMaze::generateStreaming(MazeRowCallback callback, void* user_data) {
+    setAlgorithm(MazeAlgorithm::Eller);
+    beginGenerate();
+    while (nextEllerRow()) {
+        if (callback) callback(eller.rowIndex(), eller.rowWalls(), COLS, user_data);
+    }
+    completeGenerate();
+}
+
+
+
+void RectangularMaze::finishGenerate() {
+    buildWallRuns();
+
+    const int spawn = spawn_r * COLS + spawn_c;
+    analyzer.run(*this, spawn, exit_r * COLS + exit_c);
+    if (exit_placement != ExitPlacement::Farthest) return;
+
+    // Walk the border once, top and bottom rows then the side columns
+    int best_r = exit_r, best_c = exit_c;
+    uint16_t best_d = 0;
+    auto consider = [&](int r, int c) {
+        uint16_t d = analyzer.distance(r * COLS + c);
+        if (d != MazeAnalyzer::UNREACHED && d > best_d) { best_d = d; best_r = r; best_c = c; }
+    };
+    for (int c = 0; c < COLS; ++c) { consider(0, c); consider(ROWS - 1, c); }
+    for (int r = 1; r < ROWS - 1; ++r) { consider(r, 0); consider(r, COLS - 1); }
+
+    setExitCell(best_r, best_c);
+    analyzer.setTarget(best_r * COLS + best_c);
+}
+
+
+
+void RectangularMaze::beginDraw(lv_obj_t* parent) {
     // remove any existing walls/exit
     lv_obj_clean(parent);
-    wall_count = 0; // Reset for redraw
-
-    // Draw Horizontal walls
-    for (int r = 0; r <= ROWS; ++r) {
-        for (int c = 0; c < COLS; ++c) {
-            if (horiz_walls[r][c]) {
-                if (wall_count < wall_points.size()) {
-                    wall_points[wall_count][0] = { (lv_coord_t)(c * CELL_SIZE + OFFSET), (lv_coord_t)(r * CELL_SIZE + OFFSET) };
-                    wall_points[wall_count][1] = { (lv_coord_t)((c + 1) * CELL_SIZE + OFFSET), (lv_coord_t)(r * CELL_SIZE + OFFSET) };
-
-                    lv_obj_t* wall = lv_line_create(parent);
-                    lv_line_set_points(wall, wall_points[wall_count].data(), 2);
-                    lv_obj_add_style(wall, &style_wall, 0);
-                    wall_count++;
-                    if(animate) lv_timer_handler();
+    draw_parent = parent;
+    draw_cursor = 0;
+    wall_layer.begin(parent);
+}
+
+
+
+void RectangularMaze::buildWallRuns() {
+    wall_runs.clear();
+    wall_edges = 0;
+
+    // Walk each grid line once, a run stays open while the next edge is a wall too
+    for (int pass = 0; pass < 2; ++pass) {
+        const bool horizontal = pass == 0;
+        const int lines = horizontal ? ROWS + 1 : COLS + 1;
+        const int length = horizontal ? COLS : ROWS;
+        for (int line = 0; line < lines; ++line) {
+            int start = -1;
+            for (int i = 0; i <= length; ++i) {
+                bool wall = i < length && (horizontal ? hasHorizWall(line, i) : hasVertWall(i, line));
+                if (wall) {
+                    if (start < 0) start = i;
+                    ++wall_edges;
+                } else if (start >= 0) {
+                    wall_runs.push_back({ (uint8_t)horizontal, (uint16_t)line, (uint16_t)start, (uint16_t)i });
+                    start = -1;
                 }
             }
         }
     }
+}
 
-    //  Draw Vertical walls
-    for (int r = 0; r < ROWS; ++r) {
-        for (int c = 0; c <= COLS; ++c) {
-            if (vert_walls[r][c]) {
-                if (wall_count < wall_points.size()) {
-                    wall_points[wall_count][0] = { (lv_coord_t)(c * CELL_SIZE + OFFSET), (lv_coord_t)(r * CELL_SIZE + OFFSET) };
-                    wall_points[wall_count][1] = { (lv_coord_t)(c * CELL_SIZE + OFFSET), (lv_coord_t)((r + 1) * CELL_SIZE + OFFSET) };
-
-                    lv_obj_t* wall = lv_line_create(parent);
-                    lv_line_set_points(wall, wall_points[wall_count].data(), 2);
-                    lv_obj_add_style(wall, &style_wall, 0);
-                    wall_count++;
-                    if(animate) lv_timer_handler();
-                }
-            }
+
+
+bool RectangularMaze::drawStep(uint32_t max_walls) {
+    // One line per merged wall, a wall run is always a straight 2 point line
+    const int total_slots = (int)wall_runs.size();
+
+    while (draw_cursor < total_slots && max_walls > 0) {
+        const WallRun& w = wall_runs[draw_cursor++];
+        const lv_coord_t along = (lv_coord_t)(w.line * CELL_SIZE + OFFSET);
+        const lv_coord_t from = (lv_coord_t)(w.from * CELL_SIZE + OFFSET);
+        const lv_coord_t to = (lv_coord_t)(w.to * CELL_SIZE + OFFSET);
+        if (w.horizontal) {
+            wall_layer.addLine({ from, along }, { to, along });
+        } else {
+            wall_layer.addLine({ along, from }, { along, to });
         }
+        --max_walls;
     }
+    wall_layer.flush();
+    if (draw_cursor < total_slots) return false;
+
+    if (draw_cursor == total_slots) {
+        // Draw Exit Cell (red)
+        lv_obj_t* exitObj = lv_obj_create(draw_parent);
+        lv_obj_set_size(exitObj, CELL_SIZE-2, CELL_SIZE-2);
+        lv_obj_set_pos(exitObj, exit_px.x, exit_px.y);
+        lv_obj_set_style_bg_color(exitObj, lv_color_make(255, 0, 0), 0);
+        lv_obj_set_style_border_width(exitObj, 0, 0);
+        lv_obj_set_style_radius(exitObj, 0, 0); // makes it square
+        draw_cursor++;
+    }
+    return true;
+}
+
 
 
-    // Draw Exit Cell (red)
-    lv_obj_t* exitObj = lv_obj_create(parent);
-    lv_obj_set_size(exitObj, CELL_SIZE-2, CELL_SIZE-2);
-    lv_obj_set_pos(exitObj, exit_px.x, exit_px.y);
-    lv_obj_set_style_bg_color(exitObj, lv_color_make(255, 0, 0), 0);
-    lv_obj_set_style_border_width(exitObj, 0, 0);
-    lv_obj_set_style_radius(exitObj, 0, 0); // makes it square
-
-    // Final actual draw to screen
-    lv_timer_handler();
-}
-
-
-
-void RectangularMaze::carve(int r, int c) {
-  visited_cells[r][c] = true;
-  const int dr[4] = {-1,1,0,0}, dc[4] = {0,0,-1,1};
-  int dirs[4] = {0,1,2,3};
-  // Fisher-Yates shuffle
-  for (int i = 3; i > 0; i--) {
-    int j = random(i+1);
-    int t = dirs[i];
-    dirs[i] = dirs[j];
-    dirs[j] = t;
-  }
-  // might switch to stack implementation rather than recursive
-  for (int i = 0; i < 4; i++) {
-    int d = dirs[i];
-    int nr = r + dr[d];
-    int nc = c + dc[d];
-    // checks in random order around cell if neighboring cells are visited, knocks down wall, recurses
-    if (nr >= 0 && nr < ROWS && nc >= 0 && nc < COLS && !visited_cells[nr][nc]) {
-      if (d < 2) horiz_walls[max(r,nr)][c] = false;
-      else if (d == 2) vert_walls[r][c] = false;
-      else vert_walls[r][c+1] = false;
-      carve(nr, nc);
+int RectangularMaze::neighbors(int cell, int* out) const {
+    int r = cell / COLS;
+    int c = cell - r * COLS;
+    int n = 0;
+    if (r > 0)        out[n++] = cell - COLS; // up
+    if (r < ROWS - 1) out[n++] = cell + COLS; // down
+    if (c > 0)        out[n++] = cell - 1;    // left
+    if (c < COLS - 1) out[n++] = cell + 1;    // right
+    return n;
+}
+
+
+int RectangularMaze::openNeighbors(int cell, int* out) const {
+    // border walls are always up, so no range checks are needed
+    const uint8_t w = cell_walls[cell];
+    int n = 0;
+    if (!(w & WALL_N)) out[n++] = cell - COLS;
+    if (!(w & WALL_S)) out[n++] = cell + COLS;
+    if (!(w & WALL_W)) out[n++] = cell - 1;
+    if (!(w & WALL_E)) out[n++] = cell + 1;
+    return n;
+}
+
+
+void RectangularMaze::link(int a, int b) {
+    if (a > b) { int t = a; a = b; b = t; }
+    if (b - a == COLS) {          // b is below a
+        cell_walls[a] &= ~WALL_S;
+        cell_walls[b] &= ~WALL_N;
+    } else {                      // b is right of a
+        cell_walls[a] &= ~WALL_E;
+        cell_walls[b] &= ~WALL_W;
     }
-  }
 }
 
 
 void RectangularMaze::placeExitAndSpawn() {
     // Pick a random side & cell on that side
-    int side = random(4); // 0=TOP,1=RIGHT,2=BOTTOM,3=LEFT
-    if (side == 0) { exit_r = 0;        exit_c = random(COLS);}
-    if (side == 1) { exit_r = random(ROWS); exit_c = COLS-1;}
-    if (side == 2) { exit_r = ROWS-1;   exit_c = random(COLS);}
-    if (side == 3) { exit_r = random(ROWS); exit_c = 0;}
+    int side = rng.below(4); // 0=TOP,1=RIGHT,2=BOTTOM,3=LEFT
+    if (side == 0) { exit_r = 0;        exit_c = rng.below(COLS);}
+    if (side == 1) { exit_r = rng.below(ROWS); exit_c = COLS-1;}
+    if (side == 2) { exit_r = ROWS-1;   exit_c = rng.below(COLS);}
+    if (side == 3) { exit_r = rng.below(ROWS); exit_c = 0;}
 
     // Opposite corner for spawn (mirror across center)
     spawn_r = (ROWS-1) - exit_r;
@@ -148,8 +237,7 @@ void RectangularMaze::placeExitAndSpawn() {
 
     // Pixel coords
     // Note: lvgl zero index (0,0) is top left corner 
-    exit_px = { (lv_coord_t)(exit_c*CELL_SIZE + OFFSET),
-                (lv_coord_t)(exit_r*CELL_SIZE + OFFSET)};
+    setExitCell(exit_r, exit_c);
 
     ball_spawn_px = { (lv_coord_t)(spawn_c*CELL_SIZE + OFFSET + CELL_SIZE/2),
                       (lv_coord_t)(spawn_r*CELL_SIZE + OFFSET + CELL_SIZE/2) };
@@ -157,40 +245,34 @@ void RectangularMaze::placeExitAndSpawn() {
 
 
 
+void RectangularMaze::setExitCell(int r, int c) {
+    exit_r = r;
+    exit_c = c;
+    exit_px = { (lv_coord_t)(exit_c*CELL_SIZE + OFFSET),
+                (lv_coord_t)(exit_r*CELL_SIZE + OFFSET)};
+}
+
+
+
+int RectangularMaze::cellAtPixel(float x, float y) const {
+    int col = (int)floorf((x - OFFSET) / CELL_SIZE);
+    int row = (int)floorf((y - OFFSET) / CELL_SIZE);
+    if (col < 0 || col >= COLS || row < 0 || row >= ROWS) return -1;
+    return row * COLS + col;
+}
+
+
+lv_point_t RectangularMaze::cellCenterPixel(int cell) const {
+    int r = cell / COLS, c = cell % COLS;
+    return { (lv_coord_t)(c*CELL_SIZE + OFFSET + CELL_SIZE/2),
+             (lv_coord_t)(r*CELL_SIZE + OFFSET + CELL_SIZE/2) };
+}
+
+
+
 void RectangularMaze::handleCollisions(Ball& ball) {
-    float ball_x = ball.getX();
-    float ball_y = ball.getY();
-    float ball_r = ball.getRadius();
-
-    int col = (int)((ball_x - OFFSET) / CELL_SIZE);
-    int row = (int)((ball_y - OFFSET) / CELL_SIZE);
-
-    // Clamp to the playable grid
-    if (col < 0) col = 0;
-    if (col > COLS - 1) col = COLS - 1;
-    if (row < 0) row = 0;
-    if (row > ROWS - 1) row = ROWS - 1;
-
-    // Left wall
-    if (vert_walls[row][col] && (ball_x - ball_r < col * CELL_SIZE + OFFSET)) {
-        ball.setX(col * CELL_SIZE + OFFSET + ball_r);
-        ball.setVelocityX(-ball.getVelocityX() * 0.25f);
-    }
-    // Right wall
-    if (vert_walls[row][col + 1] && (ball_x + ball_r > (col + 1) * CELL_SIZE + OFFSET)) {
-        ball.setX((col + 1) * CELL_SIZE + OFFSET - ball_r);
-        ball.setVelocityX(-ball.getVelocityX() * 0.25f);
-    }
-    // Top wall
-    if (horiz_walls[row][col] && (ball_y - ball_r < row * CELL_SIZE + OFFSET)) {
-        ball.setY(row * CELL_SIZE + OFFSET + ball_r);
-        ball.setVelocityY(-ball.getVelocityY() * 0.25f);
-    }
-    // Bottom wall
-    if (horiz_walls[row + 1][col] && (ball_y + ball_r > (row + 1) * CELL_SIZE + OFFSET)) {
-        ball.setY((row + 1) * CELL_SIZE + OFFSET - ball_r);
-        ball.setVelocityY(-ball.getVelocityY() * 0.25f);
-    }
+    if (const WallDistanceField* field = fieldFor(collision_mode)) field->collide(ball);
+    else collideRectCell(ball, cell_walls, geometry);
 }
 
 
@@ -198,32 +280,26 @@ void RectangularMaze::handleCollisions(Ball& ball) {
 void RectangularMaze::stepBallWithCollisions(Ball& ball,
                                              float max_step_px,
                                              uint8_t max_substeps) {
-    float dx, dy;
-    if (!ball.consumeDelta(dx, dy)) return; // no motion this frame
-
-    // Choose a safe step length: default to half the radius
-    if (max_step_px <= 0.0f) max_step_px = ball.getRadius() * 0.5f;
-
-    // Determine steps based on direction of greatest change
-    float max_axis = fabsf(dx) > fabsf(dy) ? fabsf(dx) : fabsf(dy);
-    int steps = (int)ceilf(max_axis / max_step_px);
-    if (steps < 1) steps = 1;
-    if ((uint8_t)steps > max_substeps) steps = max_substeps;
+    if (const WallDistanceField* field = fieldFor(collision_mode)) stepFieldBody(ball, *field, max_step_px, max_substeps);
+    else stepRectBody(ball, cell_walls, geometry, collision_mode, max_step_px, max_substeps);
+}
 
-    float sx = dx / steps;
-    float sy = dy / steps;
 
-    for (int i = 0; i < steps; ++i) {
-        ball.translate(sx, sy);
-        handleCollisions(ball);  // clamp/reflect if we touched any wall
-    }
+void RectangularMaze::stepSwarmWithCollisions(BallSwarm& swarm,
+                                              float max_step_px,
+                                              uint8_t max_substeps) {
+    const WallDistanceField* field = fieldFor(collision_mode);
+    swarm.forEachBody([&](BallSwarm::Body& b) {
+        if (field) stepFieldBody(b, *field, max_step_px, max_substeps);
+        else stepRectBody(b, cell_walls, geometry, collision_mode, max_step_px, max_substeps);
+    });
 }
 
 
 // Might be a better random periemter generatro since only one random call is made
 lv_point_t RectangularMaze::randomPerimeterCoord() {
     int P = 2*COLS + 2*ROWS - 4;
-    int idx = random(0, P);
+    int idx = rng.below(P);
     int r, c;
     if      (idx < COLS)        { r = 0;       c = idx;           }
     else if ((idx -= COLS) < ROWS-2) { r = 1+idx;  c = COLS-1;      }
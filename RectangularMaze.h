@@ -1,12 +1,155 @@
 #ifndef RECTANGULAR_MAZE_H
 #define RECTANGULAR_MAZE_H
 
-#include "Maze.h"
+#include "maze.h"
+#include "EllerGenerator.h"
 #include <vector>
 #include <array>
 #include "Ball.h"
+#include "BallSwarm.h"
+#include "SweptCollision.h"
 
-class RectangularMaze : public Maze {
+/**
+ * @brief Rectangular dimensions as read by the collision kernel, known at runtime.
+ * FixedRectGeometry (FixedMaze.h) has the same interface with compile time values.
+ */
+struct RectGeometry {
+    int cols_ = 0, rows_ = 0, cell_ = 1, offset_ = 0;
+    float inv_cell_ = 1.0f;
+    BallScalar ball_inv_cell_ = BallScalar(1.0f);
+
+    RectGeometry() {}
+    RectGeometry(int cols, int rows, int cell, int offset)
+        : cols_(cols), rows_(rows), cell_(cell), offset_(offset), inv_cell_(1.0f / cell),
+          ball_inv_cell_(1.0f / cell) {}
+
+    int cols() const { return cols_; }
+    int rows() const { return rows_; }
+    int cell() const { return cell_; }
+    int offset() const { return offset_; }
+    float invCell() const { return inv_cell_; }
+    BallScalar ballInvCell() const { return ball_inv_cell_; } ///< invCell() in the ball's format
+};
+
+/**
+ * @brief Resolves the ball against the walls of the cell it is in, shared by the runtime
+ * and the compile time sized mazes so both behave exactly the same
+ * @param cell_walls RectWall masks, row major
+ * @param g RectGeometry or FixedRectGeometry
+ * @param ball a Ball or a BallSwarm::Body
+ *
+ * Works in BallScalar throughout, so a fixed point build runs it on integers only.
+ */
+template <typename Geometry, typename Body>
+inline void collideRectCell(Body& ball, const uint8_t* cell_walls, const Geometry& g) {
+    BallScalar ball_x = ball.posX();
+    BallScalar ball_y = ball.posY();
+    BallScalar ball_r = ball.rad();
+    const BallScalar offset = BallScalar(g.offset());
+    const BallScalar cell = BallScalar(g.cell());
+    const BallScalar damping = BallScalar(WALL_BOUNCE);
+
+    int col = (int)((ball_x - offset) * g.ballInvCell());
+    int row = (int)((ball_y - offset) * g.ballInvCell());
+
+    // Clamp to the playable grid
+    if (col < 0) col = 0;
+    if (col > g.cols() - 1) col = g.cols() - 1;
+    if (row < 0) row = 0;
+    if (row > g.rows() - 1) row = g.rows() - 1;
+
+    // every wall around the cell in one load
+    const uint8_t walls = cell_walls[row * g.cols() + col];
+    const BallScalar left = BallScalar(col * g.cell() + g.offset());
+    const BallScalar top = BallScalar(row * g.cell() + g.offset());
+
+    // Left wall
+    if ((walls & WALL_W) && (ball_x - ball_r < left)) {
+        ball.setPosX(left + ball_r);
+        ball.setVelX(-ball.velX() * damping);
+    }
+    // Right wall
+    if ((walls & WALL_E) && (ball_x + ball_r > left + cell)) {
+        ball.setPosX(left + cell - ball_r);
+        ball.setVelX(-ball.velX() * damping);
+    }
+    // Top wall
+    if ((walls & WALL_N) && (ball_y - ball_r < top)) {
+        ball.setPosY(top + ball_r);
+        ball.setVelY(-ball.velY() * damping);
+    }
+    // Bottom wall
+    if ((walls & WALL_S) && (ball_y + ball_r > top + cell)) {
+        ball.setPosY(top + cell - ball_r);
+        ball.setVelY(-ball.velY() * damping);
+    }
+}
+
+/**
+ * @brief Earliest contact of a ball move with the walls of every cell the move can reach
+ * @param cell_walls RectWall masks, row major
+ * @param g RectGeometry or FixedRectGeometry
+ */
+template <typename Geometry>
+inline void sweepRectWalls(const Sweep& s, const uint8_t* cell_walls, const Geometry& g, SweepHit& hit) {
+    // cells under the bounding box of the move, grown by the radius
+    const float x0 = fminf(s.px, s.px + s.dx) - s.r, x1 = fmaxf(s.px, s.px + s.dx) + s.r;
+    const float y0 = fminf(s.py, s.py + s.dy) - s.r, y1 = fmaxf(s.py, s.py + s.dy) + s.r;
+    int c0 = (int)floorf((x0 - g.offset()) * g.invCell()), c1 = (int)floorf((x1 - g.offset()) * g.invCell());
+    int r0 = (int)floorf((y0 - g.offset()) * g.invCell()), r1 = (int)floorf((y1 - g.offset()) * g.invCell());
+    if (c0 < 0) c0 = 0;
+    if (r0 < 0) r0 = 0;
+    if (c1 > g.cols() - 1) c1 = g.cols() - 1;
+    if (r1 > g.rows() - 1) r1 = g.rows() - 1;
+
+    for (int row = r0; row <= r1; ++row) {
+        const float top = row * g.cell() + g.offset();
+        const float bottom = top + g.cell();
+        for (int col = c0; col <= c1; ++col) {
+            const uint8_t walls = cell_walls[row * g.cols() + col];
+            const float left = col * g.cell() + g.offset();
+            const float right = left + g.cell();
+            // shared walls are seen from both cells, testing them twice is cheaper than sorting it out
+            if (walls & WALL_N) sweepSegment(s, left, top, right, top, hit);
+            if (walls & WALL_S) sweepSegment(s, left, bottom, right, bottom, hit);
+            if (walls & WALL_W) sweepSegment(s, left, top, left, bottom, hit);
+            if (walls & WALL_E) sweepSegment(s, right, top, right, bottom, hit);
+        }
+    }
+}
+
+/**
+ * @brief Moves one ball by its pending delta with the selected collision mode, shared by the
+ * Ball and the BallSwarm paths of the runtime and compile time sized mazes
+ * @param ball a Ball or a BallSwarm::Body
+ */
+template <typename Body, typename Geometry>
+inline void stepRectBody(Body& ball, const uint8_t* cell_walls, const Geometry& g, CollisionMode mode,
+                         float max_step_px, uint8_t max_substeps) {
+    if (mode == CollisionMode::Swept) {
+        stepBallSwept(ball, [cell_walls, &g](const Sweep& s, SweepHit& hit) {
+            sweepRectWalls(s, cell_walls, g, hit);
+        });
+        return;
+    }
+    // kernel is called directly, no virtual call per substep
+    stepBallInSubsteps(ball, max_step_px, max_substeps, [cell_walls, &g](Body& b) {
+        collideRectCell(b, cell_walls, g);
+    });
+}
+
+/**
+ * @brief Straight wall spanning several cell edges, in cell units. Eight bytes, so the
+ * whole wall list of a maze can be stored or sent as is, for grids up to 65535 cells a side.
+ */
+struct WallRun {
+    uint8_t horizontal; ///< 1: along the top of row line, 0: along the left of column line
+    uint16_t line;      ///< row (horizontal) or column (vertical) of the grid line, up to ROWS / COLS
+    uint16_t from;      ///< first cell along the line
+    uint16_t to;        ///< one past the last cell along the line
+};
+
+class RectangularMaze : public Maze, private MazeGrid {
 public:
     /**
      * @brief Constructor for a dynamically-sized rectangular maze.
@@ -18,16 +161,31 @@ public:
     RectangularMaze(int cols, int rows, int cell_size, int offset);
 
     /**
-     * @brief Resets the horizontal, vertical and visited cells 2D vectors and starts the maze carving at a random point.
+     * @brief Resets the horizontal and vertical walls and primes the generator at a random cell with the selected algorithm.
      */
-    virtual void generate() override;
+    virtual void beginGenerate() override;
 
     /**
-     * @brief Draws the maze and intial ball / exit positions
+     * @brief Generates the maze row by row with Eller's algorithm, handing every finished row to
+     * callback before the next one is carved. Only O(COLS) working memory is used on top of the walls.
+     * Selects MazeAlgorithm::Eller, so getId() rebuilds the same maze through generate().
+     * For mazes taller than the wall tables, drive an EllerGenerator directly instead.
+     * @param callback consumer for each row, may be nullptr
+     * @param user_data pointer passed through to callback
+     */
+    void generateStreaming(MazeRowCallback callback, void* user_data);
+
+    /**
+     * @brief Clears parent and prepares drawing the maze and exit on it
      * @param parent LVGL screen to draw to
-     * @param animate boolean, set true if you want to see maze drawing animation
      */
-    virtual void draw(lv_obj_t* parent, bool animate) override;
+    virtual void beginDraw(lv_obj_t* parent) override;
+
+    /**
+     * @brief Adds the next max_walls merged walls to the wall layer, then the exit cell
+     * @param max_walls number of walls to add in this step
+     */
+    virtual bool drawStep(uint32_t max_walls) override;
 
     /**
      * @brief Gets ball position, simple collision check with nearby walls, moves ball outside of collision area, "bouncess" off wall 
@@ -44,6 +202,53 @@ public:
     virtual void stepBallWithCollisions(Ball& ball,
                                     float max_step_px = -1.0f,
                                     uint8_t max_substeps = 32) override;
+    virtual void stepSwarmWithCollisions(BallSwarm& swarm,
+                                    float max_step_px = -1.0f,
+                                    uint8_t max_substeps = 32) override;
+
+    virtual MazeId getId() const override;
+
+    /**
+     * @brief Walls of the last generated maze with collinear neighbouring edges merged,
+     * horizontal lines top to bottom first, then vertical lines left to right
+     */
+    const std::vector<WallRun>& wallRuns() const { return wall_runs; }
+
+    /**
+     * @brief Single cell edges per merged wall in the last generated maze
+     */
+    float wallMergeRatio() const { return wall_runs.empty() ? 0.0f : (float)wall_edges / wall_runs.size(); }
+
+protected:
+    /**
+     * @brief BFS from the spawn for the stats, then moves the exit to the farthest border cell if requested
+     */
+    virtual void finishGenerate() override;
+
+    const MazeGrid& grid() const override { return *this; }
+
+    /**
+     * @brief One Eller row per COLS units of budget when that algorithm is selected
+     */
+    bool carveStep(uint32_t budget) override;
+
+    /**
+     * @brief Same maze with wall masks kept in wall_storage (ROWS * COLS bytes) instead of the heap
+     */
+    RectangularMaze(int cols, int rows, int cell_size, int offset, uint8_t* wall_storage);
+
+    // One RectWall mask per cell (row major). Shared walls are stored on both sides so a
+    // single byte answers every wall query around a cell.
+    uint8_t* cell_walls = nullptr;
+    RectGeometry geometry;
+    EllerGenerator eller;
+
+    /**
+     * @brief Carves the next Eller row into cell_walls, false once every row is done
+     */
+    bool nextEllerRow();
+
+public:
 
     // Getters for the ball and exit spawn locations
     lv_point_t getBallSpawnPixel() const override { return ball_spawn_px; }
@@ -51,18 +256,44 @@ public:
     // note we return the center pixel of the exit box 
     lv_point_t getExitPixel() const override { return {exit_px.x + CELL_SIZE/2, exit_px.y + CELL_SIZE/2}; }
 
+    int cellAtPixel(float x, float y) const override;
+    lv_point_t cellCenterPixel(int cell) const override;
+    int exitCell() const override { return exit_r * COLS + exit_c; }
+
 private:
     int COLS; // = 8;
     int ROWS; //  = 8;
     int CELL_SIZE; // = 20;
     int OFFSET; // = 40;
 
-    std::vector<std::vector<bool>> horiz_walls;
-    std::vector<std::vector<bool>> vert_walls;
-    std::vector<std::vector<bool>> visited_cells;
-    
-    std::vector<std::array<lv_point_t, 2>> wall_points;
-    int wall_count;
+    std::vector<uint8_t> owned_walls; ///< backs cell_walls unless storage was handed in
+
+    /**
+     * @brief Horizontal wall along the top of row r (r == ROWS is the bottom border)
+     */
+    bool hasHorizWall(int r, int c) const {
+        return r < ROWS ? (cell_walls[r * COLS + c] & WALL_N) : (cell_walls[(ROWS - 1) * COLS + c] & WALL_S);
+    }
+
+    /**
+     * @brief Vertical wall along the left of column c (c == COLS is the right border)
+     */
+    bool hasVertWall(int r, int c) const {
+        return c < COLS ? (cell_walls[r * COLS + c] & WALL_W) : (cell_walls[r * COLS + COLS - 1] & WALL_E);
+    }
+
+
+    // Incremental drawing state
+    lv_obj_t* draw_parent = nullptr;
+    int draw_cursor = 0; ///< next entry of wall_runs
+
+    std::vector<WallRun> wall_runs; ///< capacity for the worst case, set in the constructor
+    int wall_edges = 0;             ///< cell edges covered by wall_runs
+
+    /**
+     * @brief Rebuilds wall_runs from cell_walls, one run per unbroken stretch of wall along a grid line
+     */
+    void buildWallRuns();
 
     // Ball and exit spawn coord variables
     int exit_r = 0, exit_c = 0;
@@ -70,18 +301,31 @@ private:
     lv_point_t ball_spawn_px = {0,0};
     lv_point_t exit_px = {0,0};
 
+    // MazeGrid view for the generator, cell index = row * COLS + col
+    int cellCount() const override { return ROWS * COLS; }
+    int rowCount() const override { return ROWS; }
+    int rowStart(int row) const override { return row * COLS; }
+    int neighbors(int cell, int* out) const override;
+    int openNeighbors(int cell, int* out) const override;
+    int northOf(int cell) const override { return cell >= COLS ? cell - COLS : -1; }
+
     /**
-     * @brief Recursive DFS for maze carving.
-     * @param r row index
-     * @param c column index
+     * @brief Removes the wall between two adjacent cells
+     * @param a cell index
+     * @param b cell index of a neighbour of a
      */
-    void carve(int r, int c);
+    void link(int a, int b) override;
 
     /**
      * @brief Picks exit on perimeter, sets opposite  coordinate as spawn
      */
     void placeExitAndSpawn(); 
 
+    /**
+     * @brief Moves the exit to cell (r, c) and updates its pixel position
+     */
+    void setExitCell(int r, int c);
+
     /**
      * @brief Returns a random lv_poimt_t that is on the perimeter of the maze NOT CURRENTLY USED
      */
@@ -0,0 +1,154 @@
+#include "SensorTrace.h"
+#include <string.h>
+#include <stdio.h>
+#ifndef ARDUINO
+#include <time.h>
+#endif
+
+
+static uint32_t floatBits(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+
+static float bitsFloat(uint32_t u) {
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+
+void TraceWriter::writeLine(const char* line) {
+#ifdef ARDUINO
+    out.print(line);
+#else
+    fputs(line, &out);
+#endif
+    ++record_count;
+}
+
+
+void TraceWriter::level(uint32_t t_us, const MazeId& id) {
+    char id_str[MazeId::STRING_SIZE];
+    id.toString(id_str);
+    char line[TraceReader::LINE_SIZE];
+    snprintf(line, sizeof(line), "@M %lu %s\n", (unsigned long)t_us, id_str);
+    writeLine(line);
+}
+
+
+void TraceWriter::frame(uint32_t t_us) {
+    char line[TraceReader::LINE_SIZE];
+    snprintf(line, sizeof(line), "@F %lu\n", (unsigned long)t_us);
+    writeLine(line);
+}
+
+
+void TraceWriter::reading(char kind, uint32_t t_us, float x, float y, float z) {
+    char line[TraceReader::LINE_SIZE];
+    snprintf(line, sizeof(line), "@%c %lu %08lX %08lX %08lX\n", kind, (unsigned long)t_us,
+             (unsigned long)floatBits(x), (unsigned long)floatBits(y), (unsigned long)floatBits(z));
+    writeLine(line);
+}
+
+
+bool TraceReader::readLine(char* buf, size_t size) {
+#ifdef ARDUINO
+    size_t n = in.readBytesUntil('\n', buf, size - 1);
+    if (n == 0 && !in.available()) return false;
+    buf[n] = '\0';
+#else
+    if (!fgets(buf, (int)size, &in)) return false;
+#endif
+    return true;
+}
+
+
+bool TraceReader::parse(const char* line, TraceRecord& r) {
+    unsigned long t, x, y, z;
+    r.kind = line[1];
+    switch (r.kind) {
+        case TraceRecord::LEVEL: {
+            char id_str[MazeId::STRING_SIZE];
+            if (sscanf(line + 2, "%lu %18s", &t, id_str) != 2) return false;
+            r.t_us = (uint32_t)t;
+            return MazeId::fromString(id_str, r.level);
+        }
+        case TraceRecord::FRAME:
+            if (sscanf(line + 2, "%lu", &t) != 1) return false;
+            r.t_us = (uint32_t)t;
+            return true;
+        case TraceRecord::GYRO:
+        case TraceRecord::ACCEL:
+            if (sscanf(line + 2, "%lu %lx %lx %lx", &t, &x, &y, &z) != 4) return false;
+            r.t_us = (uint32_t)t;
+            r.v[0] = bitsFloat((uint32_t)x);
+            r.v[1] = bitsFloat((uint32_t)y);
+            r.v[2] = bitsFloat((uint32_t)z);
+            return true;
+        default:
+            return false;
+    }
+}
+
+
+bool TraceReader::peek(TraceRecord& r) {
+    if (!has_ahead) {
+        char line[LINE_SIZE];
+        while (true) {
+            if (!readLine(line, sizeof(line))) return false;
+            if (line[0] != '@') continue; // serial log around the trace
+            if (parse(line, ahead)) break;
+            ++bad_lines;
+        }
+        has_ahead = true;
+    }
+    r = ahead;
+    return true;
+}
+
+
+bool TraceReader::next(TraceRecord& r) {
+    if (!peek(r)) return false;
+    has_ahead = false;
+    ++record_count;
+    return true;
+}
+
+
+bool SessionClock::frame() {
+    if (reader) {
+        // readings the game didn't ask for this time are skipped, the frame times stay in step
+        TraceRecord r;
+        while (reader->peek(r) && r.kind != TraceRecord::LEVEL) {
+            reader->next(r);
+            if (r.kind != TraceRecord::FRAME) continue;
+            now_us = r.t_us;
+            return true;
+        }
+        return false;
+    }
+    now_us = liveMicros();
+    if (writer) writer->frame(now_us);
+    return true;
+}
+
+
+uint32_t SessionClock::startLevel(const MazeId& id) {
+    const uint32_t t = liveMicros();
+    if (writer) writer->level(t, id);
+    return t;
+}
+
+
+uint32_t SessionClock::liveMicros() {
+#ifdef ARDUINO
+    return micros();
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000);
+#endif
+}
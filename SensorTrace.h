@@ -0,0 +1,140 @@
+#ifndef SENSOR_TRACE_H
+#define SENSOR_TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "MazeId.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+typedef Print TraceOut;  // Serial, or a file on the SD card
+typedef Stream TraceIn;
+#else
+#include <stdio.h>
+typedef FILE TraceOut;
+typedef FILE TraceIn;
+#endif
+
+/**
+ * @brief One line of a sensor trace.
+ *
+ * A trace is text, one record per line, each starting with '@' so it can be mixed into the
+ * serial log and cut out of a capture with grep. Floats are written as the 8 hex digits of
+ * their bits, so a replay reads back exactly what the sensor returned.
+ *
+ *     @M <us> <maze id>     a level starts (the ball's clock starts at us), MazeId::toString()
+ *     @F <us>               a frame starts, the time its game logic runs on
+ *     @G <us> <x> <y> <z>   gyro read, degrees per second
+ *     @A <us> <x> <y> <z>   accelerometer read, g
+ */
+struct TraceRecord {
+    enum Kind : char { NONE = 0, LEVEL = 'M', FRAME = 'F', GYRO = 'G', ACCEL = 'A' };
+
+    char kind = NONE;
+    uint32_t t_us = 0;
+    float v[3] = {0.0f, 0.0f, 0.0f};
+    MazeId level;
+};
+
+/**
+ * @class TraceWriter
+ * @brief Appends records to a trace
+ */
+class TraceWriter {
+public:
+    explicit TraceWriter(TraceOut& out) : out(out) {}
+
+    void level(uint32_t t_us, const MazeId& id);
+    void frame(uint32_t t_us);
+    void reading(char kind, uint32_t t_us, float x, float y, float z);
+
+    uint32_t records() const { return record_count; }
+
+private:
+    TraceOut& out;
+    uint32_t record_count = 0;
+
+    void writeLine(const char* line);
+};
+
+/**
+ * @class TraceReader
+ * @brief Reads a trace back one record at a time, lines without a leading '@' are skipped
+ */
+class TraceReader {
+public:
+    static constexpr size_t LINE_SIZE = 64;
+
+    explicit TraceReader(TraceIn& in) : in(in) {}
+
+    /**
+     * @brief Looks at the next record without taking it
+     * @return false at the end of the trace
+     */
+    bool peek(TraceRecord& r);
+
+    /**
+     * @brief Takes the next record
+     * @return false at the end of the trace
+     */
+    bool next(TraceRecord& r);
+
+    uint32_t records() const { return record_count; }
+    uint32_t badLines() const { return bad_lines; } ///< '@' lines that didn't parse
+
+private:
+    TraceIn& in;
+    TraceRecord ahead;
+    bool has_ahead = false;
+    uint32_t record_count = 0;
+    uint32_t bad_lines = 0;
+
+    bool readLine(char* buf, size_t size);
+    bool parse(const char* line, TraceRecord& r);
+};
+
+/**
+ * @class SessionClock
+ * @brief Time the game logic runs on. Live it is micros() at the start of every frame (and
+ * written to a trace while recording), in a replay it is the frame times of the trace, so
+ * the physics takes exactly the steps it took when the trace was recorded.
+ */
+class SessionClock {
+public:
+    /**
+     * @brief Writes every frame time to w, nullptr stops recording
+     */
+    void record(TraceWriter* w) { writer = w; }
+
+    /**
+     * @brief Takes the frame times from r instead of micros(), nullptr goes back to live time
+     */
+    void replay(TraceReader* r) { reader = r; }
+
+    /**
+     * @brief Starts a frame, now() holds its time until the next one
+     * @return false if a replayed trace has no frame left before its next level record,
+     * which stays in the reader
+     */
+    bool frame();
+
+    uint32_t now() const { return now_us; }
+
+    /**
+     * @brief Time a level and its ball start at, written to the trace with the level's id
+     * while recording. A replay takes it from the level record instead.
+     */
+    uint32_t startLevel(const MazeId& id);
+
+    /**
+     * @brief Wall time in microseconds, micros() on the board
+     */
+    static uint32_t liveMicros();
+
+private:
+    TraceWriter* writer = nullptr;
+    TraceReader* reader = nullptr;
+    uint32_t now_us = 0;
+};
+
+#endif // SENSOR_TRACE_H
@@ -0,0 +1,168 @@
+#ifndef SWEPT_COLLISION_H
+#define SWEPT_COLLISION_H
+
+#include <math.h>
+#include "Ball.h"
+
+/**
+ * @brief Earliest contact found by a sweep, t is the fraction of the move (0..1) at which the
+ * ball first touches a wall, n the unit normal from the wall towards the ball
+ */
+struct SweepHit {
+    float t = 2.0f; ///< > 1: no contact during the move
+    float nx = 0.0f, ny = 0.0f;
+
+    bool found() const { return t <= 1.0f; }
+
+    void offer(float tc, float cnx, float cny) {
+        if (tc < t) { t = tc; nx = cnx; ny = cny; }
+    }
+};
+
+// Every maze's swept query gets the move as a start point, a displacement and the ball radius
+struct Sweep {
+    float px, py; ///< ball center at the start of the move
+    float dx, dy; ///< displacement over the move
+    float r;      ///< ball radius
+};
+
+/**
+ * @brief Ball against a single point (wall ends, corners)
+ */
+inline void sweepPoint(const Sweep& s, float qx, float qy, SweepHit& hit) {
+    const float ex = s.px - qx, ey = s.py - qy;
+    const float c = ex*ex + ey*ey - s.r*s.r;
+    const float b = ex*s.dx + ey*s.dy; // half of the usual b
+    if (b >= 0.0f) return;             // moving away (or not at all)
+    if (c < 0.0f) {
+        // already overlapping and closing in, stop right here
+        const float e = sqrtf(ex*ex + ey*ey);
+        if (e > 1e-6f) hit.offer(0.0f, ex / e, ey / e);
+        return;
+    }
+    const float a = s.dx*s.dx + s.dy*s.dy;
+    const float disc = b*b - a*c;
+    if (disc < 0.0f) return;
+    const float t = (-b - sqrtf(disc)) / a;
+    if (t > hit.t || t > 1.0f) return;
+    const float inv_r = 1.0f / s.r;
+    hit.offer(t, (ex + t*s.dx) * inv_r, (ey + t*s.dy) * inv_r);
+}
+
+/**
+ * @brief Ball against the flat sides of the segment a-b, the ends are left to sweepPoint
+ */
+inline void sweepSegmentSides(const Sweep& s, float ax, float ay, float bx, float by, SweepHit& hit) {
+    const float ex = bx - ax, ey = by - ay;
+    const float len = sqrtf(ex*ex + ey*ey);
+    if (len < 1e-6f) return;
+    const float ux = ex / len, uy = ey / len;
+    float nx = -uy, ny = ux;
+
+    // signed distance from the line, flipped so the ball is on the positive side
+    float dist = (s.px - ax)*nx + (s.py - ay)*ny;
+    if (dist < 0.0f) { dist = -dist; nx = -nx; ny = -ny; }
+    const float closing = s.dx*nx + s.dy*ny;
+    if (closing >= 0.0f) return;
+
+    const float t = dist < s.r ? 0.0f : (dist - s.r) / -closing;
+    if (t > hit.t || t > 1.0f) return;
+    const float along = (s.px + t*s.dx - ax)*ux + (s.py + t*s.dy - ay)*uy;
+    if (along < 0.0f || along > len) return;
+    hit.offer(t, nx, ny);
+}
+
+/**
+ * @brief Ball against a wall segment a-b, sides and both ends
+ */
+inline void sweepSegment(const Sweep& s, float ax, float ay, float bx, float by, SweepHit& hit) {
+    sweepSegmentSides(s, ax, ay, bx, by, hit);
+    sweepPoint(s, ax, ay, hit);
+    sweepPoint(s, bx, by, hit);
+}
+
+/**
+ * @brief Ball against the arc of radius R around (cx, cy) from unit direction (ax, ay)
+ * counter clockwise to (bx, by), less than half a turn. The ends are left to sweepPoint.
+ */
+inline void sweepArcSides(const Sweep& s, float cx, float cy, float R,
+                          float ax, float ay, float bx, float by, SweepHit& hit) {
+    const float ex = s.px - cx, ey = s.py - cy;
+    const float e2 = ex*ex + ey*ey;
+    const float b = ex*s.dx + ey*s.dy; // half of the usual b
+    const float a = s.dx*s.dx + s.dy*s.dy;
+    if (a <= 0.0f) return;
+
+    // the ball touches the arc from inside at R - r, from outside at R + r
+    const bool inside = e2 < R*R;
+    const float rho = inside ? R - s.r : R + s.r;
+    const float c = e2 - rho*rho;
+    float t;
+    if (inside ? c >= 0.0f : c <= 0.0f) {
+        // already overlapping, only a hit if still closing in
+        if (inside ? b <= 0.0f : b >= 0.0f) return;
+        t = 0.0f;
+    } else {
+        const float disc = b*b - a*c;
+        if (disc < 0.0f) return;
+        // from inside the contact circle is left at the far root, from outside entered at the near one
+        t = inside ? (-b + sqrtf(disc)) / a : (-b - sqrtf(disc)) / a;
+        if (t < 0.0f) return;
+    }
+    if (t > hit.t || t > 1.0f) return;
+
+    // contact has to be within the arc's angles
+    const float qx = ex + t*s.dx, qy = ey + t*s.dy;
+    if (ax*qy - ay*qx < 0.0f || qx*by - qy*bx < 0.0f) return;
+    const float q = sqrtf(qx*qx + qy*qy);
+    if (q < 1e-6f) return;
+    const float sign = inside ? -1.0f : 1.0f;
+    hit.offer(t, sign * qx / q, sign * qy / q);
+}
+
+/**
+ * @brief Moves the ball by its pending delta without ever passing through a wall.
+ *
+ * query(sweep, hit) reports the earliest contact with any wall near the move. The ball goes
+ * up to the contact, bounces off with the same damped reflection as the substep kernels and
+ * slides along the wall with what is left of the move, MAX_SWEEPS queries per move at most.
+ * ball is a Ball or a BallSwarm::Body.
+ */
+template <typename Body, typename Query>
+inline void stepBallSwept(Body& ball, Query query) {
+    static constexpr int MAX_SWEEPS = 3;
+    static constexpr float SKIN = 1e-3f; // kept between ball and wall so the next sweep starts clear
+
+    Sweep s;
+    if (!ball.consumeDelta(s.dx, s.dy)) return;
+    s.r = ball.getRadius();
+
+    for (int i = 0; i < MAX_SWEEPS; ++i) {
+        s.px = ball.getX();
+        s.py = ball.getY();
+        SweepHit hit;
+        query(s, hit);
+        if (!hit.found()) {
+            ball.translate(s.dx, s.dy);
+            return;
+        }
+        ball.translate(s.dx * hit.t + hit.nx * SKIN, s.dy * hit.t + hit.ny * SKIN);
+
+        float vx = ball.getVelocityX(), vy = ball.getVelocityY();
+        reflectOffWall(vx, vy, hit.nx, hit.ny);
+        ball.setVelocityX(vx);
+        ball.setVelocityY(vy);
+
+        // rest of the move, minus the part into the wall
+        s.dx *= 1.0f - hit.t;
+        s.dy *= 1.0f - hit.t;
+        const float dn = s.dx*hit.nx + s.dy*hit.ny;
+        if (dn < 0.0f) {
+            s.dx -= dn * hit.nx;
+            s.dy -= dn * hit.ny;
+        }
+        if (s.dx*s.dx + s.dy*s.dy < 1e-8f) return;
+    }
+}
+
+#endif // SWEPT_COLLISION_H
@@ -0,0 +1,83 @@
+#include "TraceRunner.h"
+#include <string.h>
+#include "Ball.h"
+#include "IMU.h"
+#include "ImuSource.h"
+
+
+static uint32_t hashFloat(uint32_t h, float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    for (int i = 0; i < 4; ++i) {
+        h ^= (u >> (8 * i)) & 0xFF;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+
+TraceRunner::Result TraceRunner::run(TraceReader& trace) {
+    Result res;
+    res.path_hash = 2166136261u;
+
+    SessionClock clock;
+    clock.replay(&trace);
+    ReplayImuSource source(trace);
+    IMU imu; // same threshold and averaging as the sketch
+    imu.setSource(&source);
+
+    // never loaded, nothing is rendered
+    lv_obj_t* screen = lv_obj_create(nullptr);
+    Maze* maze = nullptr;
+    Ball* ball = nullptr;
+
+    TraceRecord r;
+    while (trace.peek(r)) {
+        if (r.kind == TraceRecord::LEVEL) {
+            trace.next(r);
+            delete ball;
+            delete maze;
+            ball = nullptr;
+            maze = createMaze(r.level);
+            if (!maze) continue;
+            maze->generate();
+            // the distance field is built from the drawn walls
+            if (mode == CollisionMode::DistanceField) maze->draw(screen, false);
+            maze->setCollisionMode(mode);
+
+            const lv_point_t spawn = maze->getBallSpawnPixel();
+            ball = new Ball(screen, spawn.x, spawn.y, radius);
+            ball->setPhysicsRate(physics_hz);
+            ball->restartClock(r.t_us);
+            ++res.levels;
+            continue;
+        }
+        if (!clock.frame()) continue;
+        ++res.frames;
+
+        // the sketch's loop, minus drawing
+        float roll = 0.0f, pitch = 0.0f;
+        if (imu.read()) imu.getRollAndPitch(roll, pitch);
+        if (!ball) continue;
+
+        const uint32_t t0 = SessionClock::liveMicros();
+        const int steps = ball->advanceClock(clock.now());
+        for (int i = 0; i < steps; ++i) {
+            ball->updatePhysics(roll, pitch);
+            maze->stepBallWithCollisions(*ball, ball->getRadius() * 0.5f, 24);
+        }
+        res.physics_us += SessionClock::liveMicros() - t0;
+        res.steps += steps;
+        res.path_hash = hashFloat(hashFloat(res.path_hash, ball->getX()), ball->getY());
+    }
+
+    if (ball) {
+        res.x = ball->getX();
+        res.y = ball->getY();
+    }
+    res.mismatches = source.mismatches();
+    delete ball;
+    delete maze;
+    lv_obj_del(screen);
+    return res;
+}
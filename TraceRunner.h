@@ -0,0 +1,49 @@
+#ifndef TRACE_RUNNER_H
+#define TRACE_RUNNER_H
+
+#include <lvgl.h>
+#include "maze.h"
+#include "SensorTrace.h"
+
+/**
+ * @class TraceRunner
+ * @brief Plays a recorded sensor trace through the maze and ball physics of the sketch's loop,
+ * without drawing: the same levels, the same readings at the same frame times, so the ball
+ * takes exactly the same path on every run and every machine with the same float math.
+ *
+ * The path hash makes a trace a regression check for physics and collision changes, the
+ * time spent in the physics makes it a benchmark. Nothing in it touches the hardware, a Linux
+ * build with LVGL and an Arduino.h that provides micros() replays captures from the serial
+ * port (lv_init() first).
+ * Only the player's ball is replayed, BALL_COUNT > 1 sessions spawn the others from the
+ * session seed, which the trace doesn't hold.
+ */
+class TraceRunner {
+public:
+    struct Result {
+        uint32_t levels = 0;
+        uint32_t frames = 0;
+        uint32_t steps = 0;        ///< fixed physics steps
+        uint32_t physics_us = 0;   ///< wall time in updatePhysics and the collision pass
+        uint32_t mismatches = 0;   ///< readings the replay asked for that the trace didn't have next
+        uint32_t path_hash = 0;    ///< FNV-1a over the ball position after every frame
+        float x = 0.0f, y = 0.0f;  ///< where the ball ended up
+    };
+
+    // Must match the recording session, see maze_game.ino
+    void setCollisionMode(CollisionMode m) { mode = m; }
+    void setPhysicsRate(uint16_t hz) { physics_hz = hz; }
+    void setBallRadius(float r) { radius = r; }
+
+    /**
+     * @brief Replays the whole trace
+     */
+    Result run(TraceReader& trace);
+
+private:
+    CollisionMode mode = CollisionMode::Substep;
+    uint16_t physics_hz = BALL_PHYSICS_HZ;
+    float radius = 5.0f;
+};
+
+#endif // TRACE_RUNNER_H
@@ -0,0 +1,94 @@
+#include "TriangleMaze.h"
+#include <math.h>
+
+
+TriangleMaze::TriangleMaze(int cols, int rows, int side) {
+    COLS = cols;
+    ROWS = rows;
+    SIDE = side;
+    height = SIDE * 0.8660254f;
+
+    // center the grid on the 240 x 240 screen
+    origin_x = 120.0f - (COLS + 1) * SIDE / 4.0f;
+    origin_y = 120.0f - ROWS * height / 2;
+
+    topology.clear(COLS * ROWS, COLS * ROWS * 3);
+    for (int r = 0; r < ROWS; ++r) {
+        topology.beginRow();
+        for (int c = 0; c < COLS; ++c) {
+            const int cell = r * COLS + c;
+            topology.addCell(3);
+            if (c > 0) topology.addNeighbor(cell - 1, TRI_W);
+            if (c + 1 < COLS) topology.addNeighbor(cell + 1, TRI_E);
+            // only triangles pointing down have a neighbour to the north
+            if (pointsUp(r, c)) {
+                if (r + 1 < ROWS) topology.addNeighbor(cell + COLS, TRI_FLAT);
+            } else {
+                if (r > 0) topology.addNeighbor(cell - COLS, TRI_FLAT, true);
+            }
+        }
+    }
+    initTopology(SIDE / 3);
+}
+
+
+MazeId TriangleMaze::getId() const {
+    MazeId id;
+    id.type = MazeType::Triangle;
+    id.algorithm = getAlgorithm();
+    id.dims[0] = COLS;
+    id.dims[1] = ROWS;
+    id.dims[2] = SIDE;
+    id.seed = seed;
+    id.exit_placement = exit_placement;
+    return id;
+}
+
+
+lv_point_t TriangleMaze::cellCenterPixel(int cell) const {
+    int r = cell / COLS, c = cell % COLS;
+    // centroid sits a third of the height away from the flat side
+    float x = origin_x + (c + 1) * SIDE / 2.0f;
+    float y = origin_y + r * height + (pointsUp(r, c) ? 2.0f : 1.0f) * height / 3;
+    return { (lv_coord_t)lroundf(x), (lv_coord_t)lroundf(y) };
+}
+
+
+int TriangleMaze::cellAtPixel(float x, float y) const {
+    float fr = (y - origin_y) / height;
+    if (fr < 0.0f || fr >= ROWS) return -1;
+    int r = (int)fr;
+    float v = fr - r;                      // 0 at the top of the row, 1 at the bottom
+    float u = (x - origin_x) / (SIDE / 2.0f); // cell c spans u in [c, c + 2]
+    if (u < 0.0f || u >= COLS + 1) return -1;
+
+    // u falls in cell k or k - 1, split by the slanted side between them
+    int k = (int)u;
+    float f = u - k;
+    int c = pointsUp(r, k) ? (f >= 1.0f - v ? k : k - 1)
+                           : (f >= v ? k : k - 1);
+    if (c < 0 || c >= COLS) return -1;
+    return r * COLS + c;
+}
+
+
+void TriangleMaze::wallSegment(int cell, int port, float& x0, float& y0, float& x1, float& y1) const {
+    int r = cell / COLS, c = cell % COLS;
+    const float left = origin_x + c * SIDE / 2.0f;
+    const float mid = left + SIDE / 2.0f;
+    const float right = left + SIDE;
+    const float top = origin_y + r * height;
+    const float bottom = top + height;
+
+    if (pointsUp(r, c)) {
+        // apex on top, flat side at the bottom
+        if (port == TRI_W)      { x0 = mid;  y0 = top;    x1 = left;  y1 = bottom; }
+        else if (port == TRI_E) { x0 = mid;  y0 = top;    x1 = right; y1 = bottom; }
+        else                    { x0 = left; y0 = bottom; x1 = right; y1 = bottom; }
+    } else {
+        // flat side on top, apex at the bottom
+        if (port == TRI_W)      { x0 = left;  y0 = top; x1 = mid;   y1 = bottom; }
+        else if (port == TRI_E) { x0 = right; y0 = top; x1 = mid;   y1 = bottom; }
+        else                    { x0 = left;  y0 = top; x1 = right; y1 = top; }
+    }
+}
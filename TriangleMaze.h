@@ -0,0 +1,42 @@
+#ifndef TRIANGLE_MAZE_H
+#define TRIANGLE_MAZE_H
+
+#include "GraphMaze.h"
+
+/**
+ * @class TriangleMaze
+ * @brief Maze of equilateral triangles, alternating up and down in every row, centered on screen.
+ *
+ * Cell (r, c) points up when r + c is even. Neighbours share the slanted sides within a row,
+ * and the flat side with the row below (pointing up) or above (pointing down).
+ */
+class TriangleMaze : public GraphMaze {
+public:
+    /**
+     * @param cols triangles per row
+     * @param rows number of rows
+     * @param side edge length in pixels
+     */
+    TriangleMaze(int cols, int rows, int side);
+
+    virtual MazeId getId() const override;
+
+    int cellAtPixel(float x, float y) const override;
+    lv_point_t cellCenterPixel(int cell) const override;
+
+protected:
+    void wallSegment(int cell, int port, float& x0, float& y0, float& x1, float& y1) const override;
+
+private:
+    enum TrianglePort : uint8_t { TRI_W, TRI_E, TRI_FLAT };
+
+    int COLS;
+    int ROWS;
+    int SIDE;
+    float height;             ///< row height, side * sqrt(3) / 2
+    float origin_x, origin_y; ///< top left corner of the grid
+
+    bool pointsUp(int r, int c) const { return ((r + c) & 1) == 0; }
+};
+
+#endif // TRIANGLE_MAZE_H
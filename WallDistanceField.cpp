@@ -0,0 +1,133 @@
+#include "WallDistanceField.h"
+#include <math.h>
+
+// field.assign() binds it to a reference, without this line gnu++11 cores don't link
+constexpr uint16_t WallDistanceField::NO_SEGMENT;
+
+
+bool WallDistanceField::step(const WallLayer& source, uint32_t max_lines) {
+    if (field.empty() || layer != &source || layer_revision != source.revision()) {
+        layer = &source;
+        restart(source.revision());
+    }
+
+    while (next_line < layer->lineCount() && max_lines > 0) {
+        int count;
+        const lv_point_t* pts = layer->line(next_line++, count);
+        const int first = (int)(pts - &layer->point(0));
+        for (int i = 0; i + 1 < count; ++i) addSegment(first + i);
+        --max_lines;
+    }
+    return next_line >= layer->lineCount();
+}
+
+
+void WallDistanceField::restart(uint16_t revision) {
+    // a sample on the last pixel column and row too, so every point on screen has four around it
+    cols = lv_disp_get_hor_res(nullptr) / SAMPLE_PX + 2;
+    rows = lv_disp_get_ver_res(nullptr) / SAMPLE_PX + 2;
+    field.assign(cols * rows, NO_SEGMENT);
+    next_line = 0;
+    layer_revision = revision;
+}
+
+
+float WallDistanceField::segmentDistance2(int s, float x, float y, float& qx, float& qy) const {
+    const lv_point_t& a = layer->point(s);
+    const lv_point_t& b = layer->point(s + 1);
+    const float ex = b.x - a.x, ey = b.y - a.y;
+    const float len2 = ex * ex + ey * ey;
+    float t = len2 > 0.0f ? ((x - a.x) * ex + (y - a.y) * ey) / len2 : 0.0f;
+    if (t < 0.0f) t = 0.0f;
+    if (t > 1.0f) t = 1.0f;
+    qx = a.x + t * ex;
+    qy = a.y + t * ey;
+    return (x - qx) * (x - qx) + (y - qy) * (y - qy);
+}
+
+
+void WallDistanceField::addSegment(int s) {
+    const lv_point_t& a = layer->point(s);
+    const lv_point_t& b = layer->point(s + 1);
+
+    // samples in the bounding box of the segment grown by MAX_DISTANCE
+    const float inv_sample = 1.0f / SAMPLE_PX;
+    int c0 = (int)ceilf(((a.x < b.x ? a.x : b.x) - MAX_DISTANCE) * inv_sample);
+    int c1 = (int)floorf(((a.x > b.x ? a.x : b.x) + MAX_DISTANCE) * inv_sample);
+    int r0 = (int)ceilf(((a.y < b.y ? a.y : b.y) - MAX_DISTANCE) * inv_sample);
+    int r1 = (int)floorf(((a.y > b.y ? a.y : b.y) + MAX_DISTANCE) * inv_sample);
+    if (c0 < 0) c0 = 0;
+    if (r0 < 0) r0 = 0;
+    if (c1 > cols - 1) c1 = cols - 1;
+    if (r1 > rows - 1) r1 = rows - 1;
+
+    float qx, qy;
+    for (int r = r0; r <= r1; ++r) {
+        const float y = (float)(r * SAMPLE_PX);
+        uint16_t* row = &field[r * cols];
+        for (int c = c0; c <= c1; ++c) {
+            const float x = (float)(c * SAMPLE_PX);
+            const float d2 = segmentDistance2(s, x, y, qx, qy);
+            if (d2 > MAX_DISTANCE * MAX_DISTANCE) continue;
+            if (row[c] != NO_SEGMENT && segmentDistance2(row[c], x, y, qx, qy) <= d2) continue;
+            row[c] = (uint16_t)s;
+        }
+    }
+}
+
+
+bool WallDistanceField::nearest(float x, float y, float& dist, float& nx, float& ny) const {
+    if (field.empty()) return false;
+    // off the screen reads the edge
+    int c = x > 0.0f ? (int)(x * (1.0f / SAMPLE_PX)) : 0;
+    int r = y > 0.0f ? (int)(y * (1.0f / SAMPLE_PX)) : 0;
+    if (c > cols - 2) c = cols - 2;
+    if (r > rows - 2) r = rows - 2;
+
+    const uint16_t* p = &field[r * cols + c];
+    const uint16_t around[4] = { p[0], p[1], p[cols], p[cols + 1] };
+
+    float best = MAX_DISTANCE * MAX_DISTANCE, bx = 0.0f, by = 0.0f;
+    bool found = false;
+    for (int i = 0; i < 4; ++i) {
+        const uint16_t s = around[i];
+        // neighbouring samples mostly share their segment, measure it once
+        if (s == NO_SEGMENT || (i > 0 && s == around[0]) || (i > 1 && s == around[1]) || (i > 2 && s == around[2])) continue;
+        float qx, qy;
+        const float d2 = segmentDistance2(s, x, y, qx, qy);
+        if (d2 >= best) continue;
+        best = d2;
+        bx = qx;
+        by = qy;
+        found = true;
+    }
+    if (!found) return false;
+
+    dist = sqrtf(best);
+    if (dist < 1e-4f) {
+        // right on the wall line, no side to pick
+        nx = ny = 0.0f;
+        return true;
+    }
+    nx = (x - bx) / dist;
+    ny = (y - by) / dist;
+    return true;
+}
+
+
+bool WallDistanceField::collide(float& x, float& y, float& vx, float& vy, float br) const {
+    bool touched = false;
+    // a second look for inside corners, where the first push can end up in the other wall
+    for (int pass = 0; pass < 2; ++pass) {
+        float d, nx, ny;
+        if (!nearest(x, y, d, nx, ny) || d >= br) break;
+        if (nx == 0.0f && ny == 0.0f) break;
+
+        x += nx * (br - d);
+        y += ny * (br - d);
+
+        reflectOffWall(vx, vy, nx, ny);
+        touched = true;
+    }
+    return touched;
+}
@@ -0,0 +1,104 @@
+#ifndef WALL_DISTANCE_FIELD_H
+#define WALL_DISTANCE_FIELD_H
+
+#include <lvgl.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "Ball.h"
+#include "WallLayer.h"
+
+/**
+ * @class WallDistanceField
+ * @brief Nearest wall segment of every SAMPLE_PX grid point on the screen, for distance and
+ * normal lookups that work the same for every maze shape.
+ *
+ * Built from the polylines of a WallLayer, so the ball collides with exactly the walls on
+ * screen. Each sample holds the index of the segment closest to it (2 bytes). A query reads
+ * the four samples around the ball and measures the distance to their segments, at most four:
+ * the smallest is the distance to the walls, the direction to its closest point is the wall
+ * normal. Walls are lines without an inside, like in the cell kernels, so the ball touches a
+ * wall while that distance is below its radius.
+ */
+class WallDistanceField {
+public:
+    static constexpr int SAMPLE_PX = 3;
+    // Samples farther than this from every wall have no segment. The ball sees walls within
+    // MAX_DISTANCE less a sample diagonal, keep the radius and one substep below that.
+    static constexpr float MAX_DISTANCE = 16.0f;
+    static constexpr uint16_t NO_SEGMENT = 0xFFFF;
+
+    /**
+     * @brief Adds up to max_lines more lines of the layer. Starts over by itself when the layer
+     * was begun again for a new maze, memory is taken on the first call.
+     * @return true once every line of the layer is in
+     */
+    bool step(const WallLayer& layer, uint32_t max_lines);
+
+    /**
+     * @brief Distance from (x, y) to the nearest wall in pixels
+     * @param nx, ny receive the unit direction from that wall to (x, y)
+     * @return false if no wall is within MAX_DISTANCE
+     */
+    bool nearest(float x, float y, float& dist, float& nx, float& ny) const;
+
+    /**
+     * @brief Pushes the ball out of the walls it overlaps, damped reflection like the other kernels
+     * @param ball a Ball or a BallSwarm::Body
+     */
+    template <typename Body>
+    void collide(Body& ball) const {
+        collideBody(ball, [this](float& x, float& y, float& vx, float& vy, float br) {
+            return collide(x, y, vx, vy, br);
+        });
+    }
+
+    /**
+     * @brief The same on a ball's position, velocity and radius
+     * @return true if any of them changed
+     */
+    bool collide(float& x, float& y, float& vx, float& vy, float br) const;
+
+    int lineCount() const { return next_line; }
+
+    /**
+     * @brief Bytes held by the field
+     */
+    size_t bytes() const { return field.capacity() * sizeof(uint16_t); }
+
+private:
+    std::vector<uint16_t> field; ///< cols * rows samples, row major, sample (c, r) at pixel (c, r) * SAMPLE_PX
+    int cols = 0, rows = 0;
+    const WallLayer* layer = nullptr; ///< a segment is the layer's points s and s + 1
+    int next_line = 0;                ///< first layer line not in the field yet
+    uint16_t layer_revision = 0;
+
+    /**
+     * @brief Sizes the field to the screen, no sample has a segment yet
+     */
+    void restart(uint16_t revision);
+
+    /**
+     * @brief Gives the samples within MAX_DISTANCE of segment s that are closer to it than to
+     * their current one to s
+     */
+    void addSegment(int s);
+
+    /**
+     * @brief Squared distance from (x, y) to segment s, the closest point of it in qx, qy
+     */
+    float segmentDistance2(int s, float x, float y, float& qx, float& qy) const;
+};
+
+/**
+ * @brief Moves one ball by its pending delta in substeps against the wall field, for any maze
+ * @param ball a Ball or a BallSwarm::Body
+ */
+template <typename Body>
+inline void stepFieldBody(Body& ball, const WallDistanceField& field, float max_step_px, uint8_t max_substeps) {
+    stepBallInSubsteps(ball, max_step_px, max_substeps, [&field](Body& b) {
+        field.collide(b);
+    });
+}
+
+#endif // WALL_DISTANCE_FIELD_H
@@ -0,0 +1,280 @@
+#include "WallLayer.h"
+#include <stdlib.h>
+
+#if MAZE_WALL_OBJECTS
+lv_style_t WallLayer::style_wall;
+bool WallLayer::style_initialized = false;
+#endif
+
+
+WallLayer::~WallLayer() {
+    // the screen may still be around, its draw callback must not reach a deleted layer
+    if (obj) lv_obj_del(obj);
+}
+
+
+static int rasterBits(WallRaster format) {
+    switch (format) {
+        case WallRaster::Bits1:  return 1;
+        case WallRaster::Bits2:  return 2;
+        case WallRaster::Bits4:  return 4;
+        case WallRaster::Bits8:  return 8;
+        case WallRaster::RGB565: return 16;
+        default:                 return 0;
+    }
+}
+
+
+size_t WallLayer::rasterBytes(WallRaster format, int w, int h) {
+    switch (format) {
+        case WallRaster::Bits1:  return LV_CANVAS_BUF_SIZE_INDEXED_1BIT(w, h);
+        case WallRaster::Bits2:  return LV_CANVAS_BUF_SIZE_INDEXED_2BIT(w, h);
+        case WallRaster::Bits4:  return LV_CANVAS_BUF_SIZE_INDEXED_4BIT(w, h);
+        case WallRaster::Bits8:  return LV_CANVAS_BUF_SIZE_INDEXED_8BIT(w, h);
+        case WallRaster::RGB565: return LV_CANVAS_BUF_SIZE_TRUE_COLOR(w, h);
+        default:                 return 0;
+    }
+}
+
+
+void WallLayer::reserve(int max_lines, int max_points) {
+    line_end.reserve(max_lines);
+    points.reserve(max_points);
+}
+
+
+void WallLayer::begin(lv_obj_t* parent) {
+    points.clear();
+    line_end.clear();
+    pending = {0, 0, -1, -1};
+    ++begin_count;
+    dropRaster();
+
+    if (obj && lv_obj_get_parent(obj) != parent) {
+        lv_obj_del(obj);
+        obj = nullptr;
+    }
+    if (obj) {
+        // same parent, just drop the old walls
+#if MAZE_WALL_OBJECTS
+        lv_obj_clean(obj);
+#endif
+        lv_obj_invalidate(obj);
+        return;
+    }
+
+    obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_set_size(obj, LV_PCT(100), LV_PCT(100));
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(obj, deleteEvent, LV_EVENT_DELETE, this);
+#if MAZE_WALL_OBJECTS
+    if (!style_initialized) {
+        lv_style_init(&style_wall);
+        lv_style_set_line_width(&style_wall, LINE_WIDTH);
+        lv_style_set_line_color(&style_wall, lv_color_white());
+        lv_style_set_line_rounded(&style_wall, true);
+        style_initialized = true;
+    }
+#else
+    lv_obj_add_event_cb(obj, drawEvent, LV_EVENT_DRAW_MAIN, this);
+#endif
+}
+
+
+bool WallLayer::addLine(lv_point_t a, lv_point_t b) {
+    lv_point_t pts[2] = { a, b };
+    return addPolyline(pts, 2);
+}
+
+
+bool WallLayer::addPolyline(const lv_point_t* pts, int count) {
+    // never grow past reserve(), lv_line objects point into this array
+    if (line_end.size() == line_end.capacity() || points.size() + count > points.capacity()) return false;
+
+    const int first = (int)points.size();
+    for (int i = 0; i < count; ++i) {
+        points.push_back(pts[i]);
+        if (pending.x2 < pending.x1) {
+            pending = { pts[i].x, pts[i].y, pts[i].x, pts[i].y };
+        } else {
+            if (pts[i].x < pending.x1) pending.x1 = pts[i].x;
+            if (pts[i].x > pending.x2) pending.x2 = pts[i].x;
+            if (pts[i].y < pending.y1) pending.y1 = pts[i].y;
+            if (pts[i].y > pending.y2) pending.y2 = pts[i].y;
+        }
+    }
+    line_end.push_back((uint16_t)points.size());
+
+#if MAZE_WALL_OBJECTS
+    if (obj) {
+        lv_obj_t* wall = lv_line_create(obj);
+        lv_line_set_points(wall, &points[first], count);
+        lv_obj_add_style(wall, &style_wall, 0);
+    }
+#else
+    (void)first;
+#endif
+    return true;
+}
+
+
+void WallLayer::flush() {
+    if (!obj || pending.x2 < pending.x1) return;
+#if !MAZE_WALL_OBJECTS
+    // the rounded line caps stick out by half the width
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    lv_area_t a = { (lv_coord_t)(coords.x1 + pending.x1 - LINE_WIDTH), (lv_coord_t)(coords.y1 + pending.y1 - LINE_WIDTH),
+                    (lv_coord_t)(coords.x1 + pending.x2 + LINE_WIDTH), (lv_coord_t)(coords.y1 + pending.y2 + LINE_WIDTH) };
+    lv_obj_invalidate_area(obj, &a);
+#endif
+    pending = {0, 0, -1, -1};
+}
+
+
+void WallLayer::drawEvent(lv_event_t* e) {
+    WallLayer* layer = (WallLayer*)lv_event_get_user_data(e);
+    if (layer->isRasterized()) return; // the canvas child draws the walls now
+    lv_draw_ctx_t* draw_ctx = lv_event_get_draw_ctx(e);
+    const lv_area_t* clip = draw_ctx->clip_area;
+
+    lv_area_t coords;
+    lv_obj_get_coords(layer->obj, &coords);
+
+    lv_draw_line_dsc_t dsc;
+    lv_draw_line_dsc_init(&dsc);
+    dsc.color = lv_color_white();
+    dsc.width = LINE_WIDTH;
+    dsc.round_start = 1;
+    dsc.round_end = 1;
+
+    // LVGL renders the screen in bands as tall as the draw buffer, so most segments are
+    // outside the clip area and skipped with a bounding box test
+    const lv_coord_t pad = LINE_WIDTH;
+    const lv_point_t* p = layer->points.data();
+    int first = 0;
+    for (uint16_t end : layer->line_end) {
+        for (int i = first; i + 1 < end; ++i) {
+            lv_point_t a = { (lv_coord_t)(coords.x1 + p[i].x), (lv_coord_t)(coords.y1 + p[i].y) };
+            lv_point_t b = { (lv_coord_t)(coords.x1 + p[i + 1].x), (lv_coord_t)(coords.y1 + p[i + 1].y) };
+            if ((a.x < b.x ? a.x : b.x) - pad > clip->x2 || (a.x > b.x ? a.x : b.x) + pad < clip->x1) continue;
+            if ((a.y < b.y ? a.y : b.y) - pad > clip->y2 || (a.y > b.y ? a.y : b.y) + pad < clip->y1) continue;
+            lv_draw_line(draw_ctx, &dsc, &a, &b);
+        }
+        first = end;
+    }
+}
+
+
+void WallLayer::deleteEvent(lv_event_t* e) {
+    WallLayer* layer = (WallLayer*)lv_event_get_user_data(e);
+    layer->obj = nullptr;
+    layer->raster_canvas = nullptr; // went with its parent
+}
+
+
+void WallLayer::dropRaster() {
+    if (raster_canvas) lv_obj_del(raster_canvas);
+    raster_canvas = nullptr;
+    raster_format = WallRaster::Off;
+    raster_cursor = 0;
+    // give the buffer back, the next level may not want one
+    std::vector<uint8_t>().swap(raster);
+}
+
+
+bool WallLayer::beginRaster(WallRaster format) {
+    dropRaster();
+#if MAZE_WALL_OBJECTS
+    (void)format;
+    return false;
+#else
+    if (!obj || format == WallRaster::Off) return false;
+
+    // the screen may not have been laid out yet if it was never loaded
+    lv_obj_update_layout(obj);
+    raster_w = lv_obj_get_width(obj);
+    raster_h = lv_obj_get_height(obj);
+    raster.assign(rasterBytes(format, raster_w, raster_h), 0);
+    raster_format = format;
+
+    raster_canvas = lv_canvas_create(obj);
+    lv_obj_add_flag(raster_canvas, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_clear_flag(raster_canvas, LV_OBJ_FLAG_CLICKABLE);
+    switch (format) {
+        case WallRaster::Bits1: lv_canvas_set_buffer(raster_canvas, raster.data(), raster_w, raster_h, LV_IMG_CF_INDEXED_1BIT); break;
+        case WallRaster::Bits2: lv_canvas_set_buffer(raster_canvas, raster.data(), raster_w, raster_h, LV_IMG_CF_INDEXED_2BIT); break;
+        case WallRaster::Bits4: lv_canvas_set_buffer(raster_canvas, raster.data(), raster_w, raster_h, LV_IMG_CF_INDEXED_4BIT); break;
+        case WallRaster::Bits8: lv_canvas_set_buffer(raster_canvas, raster.data(), raster_w, raster_h, LV_IMG_CF_INDEXED_8BIT); break;
+        default:                lv_canvas_set_buffer(raster_canvas, raster.data(), raster_w, raster_h, LV_IMG_CF_TRUE_COLOR); break;
+    }
+    if (format == WallRaster::RGB565) {
+        lv_canvas_fill_bg(raster_canvas, lv_color_black(), LV_OPA_COVER);
+    } else {
+        // pixels are all index 0 already
+        lv_canvas_set_palette(raster_canvas, 0, lv_color_black());
+        lv_canvas_set_palette(raster_canvas, 1, lv_color_white());
+    }
+    return true;
+#endif
+}
+
+
+void WallLayer::plotIndexed(int x, int y) {
+    if (x < 0 || y < 0 || x >= raster_w || y >= raster_h) return;
+    // rows are packed most significant pixel first, after a palette of 4 bytes per color
+    const int bits = rasterBits(raster_format);
+    const size_t palette = (size_t)4 << bits;
+    const size_t stride = ((size_t)raster_w * bits + 7) / 8;
+    const size_t bit = (size_t)x * bits;
+    uint8_t& byte = raster[palette + y * stride + bit / 8];
+    byte |= (uint8_t)(1u << (8 - bits - bit % 8)); // palette index 1
+}
+
+
+bool WallLayer::rasterStep(uint32_t max_lines) {
+    if (!raster_canvas) return true;
+    const int lines = lineCount();
+    if (raster_cursor >= lines) return true;
+
+    lv_draw_line_dsc_t dsc;
+    lv_draw_line_dsc_init(&dsc);
+    dsc.color = lv_color_white();
+    dsc.width = LINE_WIDTH;
+    dsc.round_start = 1;
+    dsc.round_end = 1;
+
+    for (; raster_cursor < lines && max_lines > 0; ++raster_cursor, --max_lines) {
+        int count;
+        const lv_point_t* p = line(raster_cursor, count);
+        if (raster_format == WallRaster::RGB565) {
+            // LVGL's own renderer, anti aliased like the live layer
+            lv_canvas_draw_line(raster_canvas, p, count, &dsc);
+            continue;
+        }
+        // LVGL can't draw into indexed canvases, plot a LINE_WIDTH square brush along each segment
+        for (int i = 0; i + 1 < count; ++i) {
+            int x0 = p[i].x, y0 = p[i].y;
+            const int x1 = p[i + 1].x, y1 = p[i + 1].y;
+            const int dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+            const int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+            int err = dx + dy;
+            while (true) {
+                for (int by = 0; by < LINE_WIDTH; ++by)
+                    for (int bx = 0; bx < LINE_WIDTH; ++bx)
+                        plotIndexed(x0 + bx - LINE_WIDTH / 2, y0 + by - LINE_WIDTH / 2);
+                if (x0 == x1 && y0 == y1) break;
+                const int e2 = 2 * err;
+                if (e2 >= dy) { err += dy; x0 += sx; }
+                if (e2 <= dx) { err += dx; y0 += sy; }
+            }
+        }
+    }
+    if (raster_cursor < lines) return false;
+
+    // swap the live drawing for the finished canvas
+    lv_obj_clear_flag(raster_canvas, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_invalidate(obj);
+    return true;
+}
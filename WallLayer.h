@@ -0,0 +1,158 @@
+#ifndef WALL_LAYER_H
+#define WALL_LAYER_H
+
+#include <lvgl.h>
+#include <vector>
+
+// 1 creates one lv_line object per wall like the mazes used to, only meant for comparing
+// heap use and frame times against the single layer
+#ifndef MAZE_WALL_OBJECTS
+#define MAZE_WALL_OBJECTS 0
+#endif
+
+/**
+ * @brief Pixel format the finished walls can be pre-rendered to, see WallLayer::beginRaster.
+ * Indexed formats use a 2 color palette (black, white) and no anti aliasing.
+ */
+enum class WallRaster : uint8_t { Off, Bits1, Bits2, Bits4, Bits8, RGB565 };
+
+/**
+ * @class WallLayer
+ * @brief All walls of a maze in one LVGL object, drawn from a point list in its draw callback.
+ *
+ * A wall is a polyline (a straight wall has 2 points, an arc a few more). Points are kept in
+ * one array with the end index of every line, so a wall costs 4 bytes per point plus 2
+ * instead of a whole lv_line object with its own allocation and style list.
+ * Capacity is fixed by reserve(), lines that don't fit are dropped.
+ */
+class WallLayer {
+public:
+    static constexpr lv_coord_t LINE_WIDTH = 2;
+
+    WallLayer() {}
+    ~WallLayer();
+
+    // the LVGL object holds a pointer back to this layer
+    WallLayer(const WallLayer&) = delete;
+    WallLayer& operator=(const WallLayer&) = delete;
+
+    /**
+     * @brief Sizes the point list, call once before the first begin()
+     * @param max_lines most walls the maze can have
+     * @param max_points most points over all those walls
+     */
+    void reserve(int max_lines, int max_points);
+
+    /**
+     * @brief Forgets all lines and puts the (empty) layer on parent, covering it
+     */
+    void begin(lv_obj_t* parent);
+
+    /**
+     * @brief Appends a straight wall, coordinates are relative to the parent
+     * @return false if the layer is full
+     */
+    bool addLine(lv_point_t a, lv_point_t b);
+
+    /**
+     * @brief Appends a wall through count points
+     * @return false if the layer is full
+     */
+    bool addPolyline(const lv_point_t* pts, int count);
+
+    /**
+     * @brief Invalidates the area of the lines added since the last flush, so they show up on the next refresh
+     */
+    void flush();
+
+    /**
+     * @brief Starts pre-rendering the walls into an off-screen canvas of the given format.
+     * Until rasterStep() finishes the walls keep being drawn from the point list, after that
+     * LVGL only copies pixels out of the canvas when something moves over the walls.
+     * @return false if the format is Off or there is nothing to render on
+     */
+    bool beginRaster(WallRaster format);
+
+    /**
+     * @brief Renders up to max_lines more walls into the canvas
+     * @return true once the canvas has replaced the live drawing (or there is no raster)
+     */
+    bool rasterStep(uint32_t max_lines);
+
+    /**
+     * @brief beginRaster() and every rasterStep() in one go
+     */
+    bool rasterize(WallRaster format) {
+        if (!beginRaster(format)) return false;
+        rasterStep(UINT32_MAX);
+        return true;
+    }
+
+    bool isRasterized() const { return raster_canvas && raster_cursor >= lineCount(); }
+
+    /**
+     * @brief Canvas buffer size (palette included) for a w x h layer
+     */
+    static size_t rasterBytes(WallRaster format, int w, int h);
+
+    int lineCount() const { return (int)line_end.size(); }
+    int pointCount() const { return (int)points.size(); }
+
+    /**
+     * @brief Bumped by every begin(), tells data derived from the lines that they were replaced
+     */
+    uint16_t revision() const { return begin_count; }
+
+    /**
+     * @brief Point i over all lines, line(0) starts at 0
+     */
+    const lv_point_t& point(int i) const { return points[i]; }
+
+    /**
+     * @brief First point and point count of line i
+     */
+    const lv_point_t* line(int i, int& count) const {
+        int first = i > 0 ? line_end[i - 1] : 0;
+        count = line_end[i] - first;
+        return &points[first];
+    }
+
+    /**
+     * @brief Bytes held by the point list
+     */
+    size_t bytes() const {
+        return points.capacity() * sizeof(lv_point_t) + line_end.capacity() * sizeof(uint16_t) + raster.capacity();
+    }
+
+    lv_obj_t* object() const { return obj; }
+
+private:
+    std::vector<lv_point_t> points;
+    std::vector<uint16_t> line_end; ///< one past the last point of every line
+    lv_obj_t* obj = nullptr;
+    lv_area_t pending = {0, 0, -1, -1}; ///< bounding box of lines not flushed yet
+    uint16_t begin_count = 0;
+
+    // Pre-rendered walls
+    std::vector<uint8_t> raster;        ///< canvas buffer, palette first for indexed formats
+    lv_obj_t* raster_canvas = nullptr;  ///< child of obj, hidden until every line is in
+    WallRaster raster_format = WallRaster::Off;
+    int raster_cursor = 0;              ///< next line to render
+    lv_coord_t raster_w = 0, raster_h = 0;
+
+    void dropRaster();
+
+    /**
+     * @brief Sets one pixel of an indexed raster to the wall color
+     */
+    void plotIndexed(int x, int y);
+
+    static void drawEvent(lv_event_t* e);
+    static void deleteEvent(lv_event_t* e);
+#if MAZE_WALL_OBJECTS
+    static lv_style_t style_wall;
+    static bool style_initialized;
+#endif
+};
+
+#endif // WALL_LAYER_H
@@ -0,0 +1,141 @@
+// Host benchmark of the pre-rendered walls (WallLayer::rasterize) against drawing them live,
+// not part of the sketch (the Arduino build compiles this file to nothing). It renders with
+// LVGL's own software renderer, so it needs a real LVGL 8.3 build with the sketch's lv_conf.h
+// settings (16 bit color) and an Arduino.h providing micros(), as the trace replay does (see
+// TraceRunner.h). No panel is needed, the flushes go nowhere. Build and run on a PC:
+//
+//   g++ -std=gnu++11 -O2 -I. -I<lvgl> -I<Arduino.h> -o raster_bench WallRasterBench.cpp FlushMonitor.cpp $MAZE_SOURCES <LVGL library>
+//   ./raster_bench
+//
+// with MAZE_SOURCES as in FixedMazeBench.cpp. For the shipping 10x10 rectangular and 10 ring
+// circular mazes and every WallRaster format (Off draws the lines live) it reports the buffer
+// size, the time to rasterize, a full screen refresh, and the refreshes of a ball rolling over
+// the walls with a scripted tilt, the case the raster is meant for. FlushMonitor counts what
+// each refresh sends to the display.
+
+#ifndef ARDUINO
+
+#include <stdio.h>
+#include <chrono>
+#include "FixedMaze.h"
+#include "FlushMonitor.h"
+
+static const lv_coord_t SCREEN = 240;
+static const int BUFFER_LINES = 10;     // the round display's draw buffer
+static const int FRAMES = 2000;
+static const int STEPS_PER_FRAME = 4;   // 240 Hz physics at 60 frames a second
+static const int TILT_EVERY = 30;       // frames between tilt changes
+
+typedef std::chrono::steady_clock Clock;
+
+static double usSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+}
+
+
+static void flushNowhere(lv_disp_drv_t* drv, const lv_area_t*, lv_color_t*) {
+    lv_disp_flush_ready(drv);
+}
+
+
+static const char* formatName(WallRaster f) {
+    switch (f) {
+        case WallRaster::Off:    return "live lines";
+        case WallRaster::Bits1:  return "1 bpp";
+        case WallRaster::Bits2:  return "2 bpp";
+        case WallRaster::Bits4:  return "4 bpp";
+        case WallRaster::Bits8:  return "8 bpp";
+        case WallRaster::RGB565: return "RGB565";
+    }
+    return "?";
+}
+
+
+/**
+ * @brief Measures one format on a drawn maze
+ */
+static void bench(const char* name, Maze& maze, WallRaster format, lv_disp_t* disp, lv_obj_t* screen, FlushMonitor& flushes) {
+    // Off drops the raster of the previous format, the layer draws its lines again
+    Clock::time_point t0 = Clock::now();
+    maze.wallLayer().rasterize(format);
+    const double raster_us = usSince(t0);
+    lv_refr_now(disp);
+
+    lv_obj_invalidate(screen);
+    t0 = Clock::now();
+    lv_refr_now(disp);
+    const double full_us = usSince(t0);
+
+    const lv_point_t spawn = maze.getBallSpawnPixel();
+    Ball ball(screen, spawn.x, spawn.y, 5.0f);
+    lv_refr_now(disp);
+    MazeRandom tilt(1234);
+    float roll = 0.0f, pitch = 0.0f;
+    double frame_us = 0.0, worst_us = 0.0;
+    flushes.reset();
+    for (int frame = 0; frame < FRAMES; ++frame) {
+        if (frame % TILT_EVERY == 0) {
+            roll = tilt.below(6001) / 100.0f - 30.0f;
+            pitch = tilt.below(6001) / 100.0f - 30.0f;
+        }
+        for (int i = 0; i < STEPS_PER_FRAME; ++i) {
+            ball.updatePhysics(roll, pitch);
+            maze.stepBallWithCollisions(ball, ball.getRadius() * 0.5f, 24);
+        }
+        ball.draw();
+        t0 = Clock::now();
+        lv_refr_now(disp);
+        const double us = usSince(t0);
+        frame_us += us;
+        if (us > worst_us) worst_us = us;
+    }
+
+    printf("%-10s %-10s %8zu %10.0f %10.0f %10.1f %10.1f %10.0f\n", name, formatName(format),
+           WallLayer::rasterBytes(format, SCREEN, SCREEN), raster_us, full_us, frame_us / FRAMES, worst_us,
+           (double)flushes.pixels() / FRAMES);
+    fflush(stdout);
+}
+
+
+int main() {
+    lv_init();
+    static lv_disp_draw_buf_t draw_buf;
+    static lv_color_t buffer[SCREEN * BUFFER_LINES];
+    lv_disp_draw_buf_init(&draw_buf, buffer, nullptr, SCREEN * BUFFER_LINES);
+    static lv_disp_drv_t driver;
+    lv_disp_drv_init(&driver);
+    driver.hor_res = SCREEN;
+    driver.ver_res = SCREEN;
+    driver.flush_cb = flushNowhere;
+    driver.draw_buf = &draw_buf;
+    lv_disp_t* disp = lv_disp_drv_register(&driver);
+    FlushMonitor flushes;
+    flushes.attach(disp);
+
+    lv_obj_t* screen = lv_obj_create(nullptr);
+    lv_obj_set_size(screen, SCREEN, SCREEN);
+    lv_obj_set_style_bg_color(screen, lv_color_black(), 0);
+    lv_scr_load(screen);
+
+    static const WallRaster FORMATS[] = {
+        WallRaster::Off, WallRaster::Bits1, WallRaster::Bits2, WallRaster::Bits4, WallRaster::Bits8, WallRaster::RGB565
+    };
+    printf("%-10s %-10s %8s %10s %10s %10s %10s %10s\n", "maze", "walls", "bytes", "raster us",
+           "full us", "frame us", "worst us", "px / frame");
+
+    ShippingRectangularMaze rect;
+    rect.setSeed(1234);
+    rect.generate();
+    rect.draw(screen, false);
+    for (WallRaster f : FORMATS) bench("rect 10x10", rect, f, disp, screen, flushes);
+    lv_obj_clean(screen);
+
+    ShippingCircularMaze circ;
+    circ.setSeed(1234);
+    circ.generate();
+    circ.draw(screen, false);
+    for (WallRaster f : FORMATS) bench("circ 10x16", circ, f, disp, screen, flushes);
+    return 0;
+}
+
+#endif // ARDUINO
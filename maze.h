@@ -2,8 +2,26 @@
 #define MAZE_H
 
 #include <lvgl.h>
+#include "MazeGenerator.h"
+#include "MazeRandom.h"
+#include "MazeId.h"
+#include "MazeAnalyzer.h"
+#include "WallLayer.h"
+#include "DrawAnimator.h"
+#include "WallDistanceField.h"
 
 class Ball; // have to forward declare ball class here
+class BallSwarm;
+
+/**
+ * @brief How stepBallWithCollisions keeps the ball out of the walls
+ */
+enum class CollisionMode : uint8_t {
+    Substep, ///< move in short substeps, resolve overlaps after each one
+    Swept,   ///< sweep the ball along the whole move, stop at the first wall it touches
+    Indexed, ///< substeps, each checked against the walls in a spatial index (circular mazes, others use Substep)
+    DistanceField ///< substeps, each looked up in a distance field of the drawn walls (any maze, once fully drawn)
+};
 
 class Maze {
 public:
@@ -13,10 +31,60 @@ public:
     virtual ~Maze() {}
 
     // Pure virtual functions that maze subclasses must implement
-    // generate / draw will generate and draw the mazes as the names suggest
-    virtual void generate() = 0;
+    // generate / draw will generate and draw the mazes as the names suggest.
+    // Both are also available in resumable form so the work can be spread over several frames.
+
+    /**
+     * @brief Resets all walls, places exit and spawn and primes the generator. Nothing is carved yet.
+     */
+    virtual void beginGenerate() = 0;
+
+    /**
+     * @brief Carves for at most budget units of work (about one cell each)
+     * @return true once the maze is complete
+     */
+    bool generateStep(uint32_t budget) {
+        if (!carveStep(budget)) return false;
+        generator.release();
+        completeGenerate();
+        return true;
+    }
 
-    virtual void draw(lv_obj_t* parent, bool animate) = 0;
+    virtual void generate() {
+        beginGenerate();
+        while (!generateStep(UINT32_MAX)) {}
+    }
+
+    /**
+     * @brief Prepares drawing the generated maze on parent, nothing is created yet
+     */
+    virtual void beginDraw(lv_obj_t* parent) = 0;
+
+    /**
+     * @brief Adds at most max_walls more walls to the wall layer, the exit marker comes with the last step
+     * @return true once the whole maze is on parent
+     */
+    virtual bool drawStep(uint32_t max_walls) = 0;
+
+    /**
+     * @brief Draws the whole maze
+     * @param parent LVGL object to draw on
+     * @param animate if true draw() returns right away and an LVGL timer adds the walls a few
+     * per frame, see drawAnimation() for the speed and a callback when it is done
+     */
+    virtual void draw(lv_obj_t* parent, bool animate) {
+        if (animate) {
+            draw_animation.startOnTimer(*this, parent);
+            return;
+        }
+        beginDraw(parent);
+        while (!drawStep(UINT32_MAX)) {}
+        // Final actual draw to screen
+        lv_timer_handler();
+    }
+
+    DrawAnimator& drawAnimation() { return draw_animation; }
+    bool isDrawing() const { return draw_animation.isRunning(); }
 
     // These are just two getters so the maze knows where to initially draw the ball and exit
     virtual lv_point_t getBallSpawnPixel() const { return {120,120}; }
@@ -42,9 +110,165 @@ public:
                                     float max_step_px = -1.0f,
                                     uint8_t max_substeps = 32) = 0;
 
+    /**
+     * @brief stepBallWithCollisions for every ball of a swarm in one loop, the collision kernel
+     * is inlined into it instead of a virtual call per ball. Contacts between the balls are
+     * left to BallSwarm::collideBalls().
+     */
+    virtual void stepSwarmWithCollisions(BallSwarm& swarm,
+                                    float max_step_px = -1.0f,
+                                    uint8_t max_substeps = 32) = 0;
+
+    /**
+     * @brief Picks the collision method of stepBallWithCollisions, the substep arguments
+     * are ignored by the swept one
+     */
+    void setCollisionMode(CollisionMode m) { collision_mode = m; }
+    CollisionMode getCollisionMode() const { return collision_mode; }
+
     // updates RTC time for maze clock, might move to maze clock class as we will probaby never have 
-    // a rectangular clock maze
-    virtual void updateTime() {}
+    // a rectangular clock maze. Returns true if anything on screen changed
+    virtual bool updateTime() { return false; }
+
+    /**
+     * @brief Selects the spanning tree algorithm used by the next generate() call
+     */
+    void setAlgorithm(MazeAlgorithm a) { generator.setAlgorithm(a); }
+    MazeAlgorithm getAlgorithm() const { return generator.getAlgorithm(); }
+
+    /**
+     * @brief Bytes of working memory the last generate() needed on top of the wall storage
+     */
+    size_t generatorPeakBytes() const { return generator.peakBytes(); }
+
+    /**
+     * @brief Sets the seed for the next generate(), the same seed always gives the same maze
+     */
+    void setSeed(uint32_t s) { seed = s; }
+    uint32_t getSeed() const { return seed; }
+
+    /**
+     * @brief Compact description (type, dimensions, algorithm, seed) that rebuilds this maze through createMaze()
+     */
+    virtual MazeId getId() const = 0;
+
+    /**
+     * @brief Selects where the next generate() puts the exit
+     */
+    void setExitPlacement(ExitPlacement p) { exit_placement = p; }
+    ExitPlacement getExitPlacement() const { return exit_placement; }
+
+    /**
+     * @brief Solution length, dead ends and branching of the last generated maze, measured from the spawn
+     */
+    const MazeStats& getStats() const { return analyzer.stats(); }
+
+    int cellCount() const { return grid().cellCount(); }
+
+    /**
+     * @brief Cell index under a screen position, -1 if the position is outside the maze
+     */
+    virtual int cellAtPixel(float x, float y) const = 0;
+
+    /**
+     * @brief Screen position of the middle of a cell
+     */
+    virtual lv_point_t cellCenterPixel(int cell) const = 0;
+
+    /**
+     * @brief Cell the exit marker sits in
+     */
+    virtual int exitCell() const = 0;
+
+    /**
+     * @brief Keeps a distance field to the exit for hints. Built right away if the maze is
+     * already generated, after every generate() from then on.
+     */
+    void enableHints(bool on) {
+        hints_enabled = on;
+        if (!on) return;
+        exit_field.reserve(grid().cellCount());
+        if (analyzer.hasRun()) exit_field.run(grid(), exitCell(), -1);
+    }
+    bool hintsEnabled() const { return hints_enabled; }
+
+    /**
+     * @brief Steps left from cell to the exit, MazeAnalyzer::UNREACHED without hints
+     */
+    uint16_t exitDistance(int cell) const { return exit_field.distance(cell); }
+
+    /**
+     * @brief Next cell on the way from cell to the exit, -1 at the exit or without hints
+     */
+    int hintNext(int cell) const {
+        uint16_t d = exit_field.distance(cell);
+        if (d == 0 || d == MazeAnalyzer::UNREACHED) return -1;
+        int nb[MazeGrid::MAX_NEIGHBORS];
+        int k = grid().openNeighbors(cell, nb);
+        for (int i = 0; i < k; ++i) {
+            if (exit_field.distance(nb[i]) == d - 1) return nb[i];
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Walls of the last draw, one polyline each, in parent coordinates
+     */
+    const WallLayer& wallLayer() const { return wall_layer; }
+    WallLayer& wallLayer() { return wall_layer; }
+
+    /**
+     * @brief Adds up to max_lines more walls of the wall layer to the distance field of
+     * CollisionMode::DistanceField, so it can be built a bit at a time after drawing. Whatever
+     * is missing is added on the first collision query in that mode.
+     * @return true once every wall is in
+     */
+    bool wallFieldStep(uint32_t max_lines) { return wall_field.step(wall_layer, max_lines); }
+    const WallDistanceField& wallField() const { return wall_field; }
+
+protected:
+    /**
+     * @brief Carving behind generateStep(), the shared generator unless a maze type has its
+     * own way for the selected algorithm
+     */
+    virtual bool carveStep(uint32_t budget) { return generator.step(budget); }
+
+    /**
+     * @brief Runs once the carving is done: analyses the maze and moves the exit if requested
+     */
+    virtual void finishGenerate() {}
+
+    /**
+     * @brief Graph view of the walls, shared by the generator, the analysis and the hints
+     */
+    virtual const MazeGrid& grid() const = 0;
+
+    /**
+     * @brief The wall distance field if mode is CollisionMode::DistanceField and the walls are
+     * all drawn, brought up to date on the way. nullptr otherwise, the maze's own kernel runs then.
+     */
+    const WallDistanceField* fieldFor(CollisionMode mode) {
+        if (mode != CollisionMode::DistanceField || isDrawing() || wall_layer.lineCount() == 0) return nullptr;
+        wall_field.step(wall_layer, UINT32_MAX);
+        return &wall_field;
+    }
+
+    void completeGenerate() {
+        finishGenerate();
+        if (hints_enabled) exit_field.run(grid(), exitCell(), -1);
+    }
+
+    MazeGenerator generator;
+    MazeAnalyzer analyzer; ///< buffers sized by the subclass constructor, so the analysis never allocates
+    ExitPlacement exit_placement = ExitPlacement::Mirrored;
+    MazeAnalyzer exit_field; ///< distances to the exit, only sized while hints are enabled
+    bool hints_enabled = false;
+    WallLayer wall_layer; ///< every wall in a single LVGL object, sized by the subclass constructor
+    WallDistanceField wall_field; ///< empty until CollisionMode::DistanceField is used
+    DrawAnimator draw_animation; ///< drives draw(parent, true)
+    CollisionMode collision_mode = CollisionMode::Substep;
+    MazeRandom rng;     ///< reseeded at the start of every generate(), used for all layout choices
+    uint32_t seed = 0;
 };
 
 #endif // MAZE_H
\ No newline at end of file
@@ -2,11 +2,19 @@
 #include <lvgl.h>
 #include "lv_xiao_round_screen.h"
 #include "IMU.h"
+#include "SensorTrace.h"
 #include "RectangularMaze.h"
 #include "CircularMaze.h"
 #include "I2C_BM8563.h"
 #include "MazeClock.h"
 #include "Ball.h"
+#include "BallSwarm.h"
+#include "MazeId.h"
+#include "MazeRandom.h"
+#include "LevelPipeline.h"
+#include "FrameTimer.h"
+#include "MazeHint.h"
+#include "FlushMonitor.h"
 
 // Screen dimensions
 #define SCREEN_WIDTH 240
@@ -19,54 +27,298 @@ static lv_color_t buf[SCREEN_WIDTH * 10];
 // RTC
 I2C_BM8563 rtc(I2C_BM8563_DEFAULT_ADDRESS, Wire);
 uint32_t last_time_update = 0;
+constexpr uint32_t CLOCK_POLL_MS = 1000;
 
 // Global objects
 Maze* maze = nullptr; // Base class pointer
 IMU imu;
 Ball* ball = nullptr; 
+BallSwarm* swarm = nullptr; // instead of ball when BALL_COUNT > 1
 
-enum class MazeType : uint8_t { Rectangular, Circular, Clock };
+// Sensor trace: every IMU reading, frame time and level goes to Serial as '@' lines between
+// the log (see SensorTrace.h). TraceRunner replays a capture with the same levels and ball path.
+constexpr bool RECORD_TRACE = false;
+TraceWriter trace(Serial);
+RecordingImuSource recording_imu(imu.sensor(), trace);
+// Time the game logic runs on, micros() at the start of each loop
+SessionClock session_clock;
 
 // >>> Set your choice here <<<
-constexpr MazeType MazeChoice = MazeType::Circular;  // Rectangular | Circular | Clock
+constexpr MazeType MazeChoice = MazeType::Circular;  // Rectangular | Circular | Clock | Hex | Triangle
+// Farthest moves the exit to the border cell with the longest path from the spawn
+constexpr ExitPlacement ExitChoice = ExitPlacement::Mirrored;  // Mirrored | Farthest
+// Breadcrumb dots from the ball towards the exit
+constexpr bool SHOW_HINTS = false;
+// Theta maze: circular sectors double going outwards so cells stay about the same size
+constexpr bool CIRCULAR_ADAPTIVE = false;
+constexpr int HINT_DOTS = 4;
+// Animated first maze: walls added per frame and time allowed for it, the game keeps running meanwhile
+constexpr bool ANIMATE_DRAW = false;
+constexpr uint16_t DRAW_WALLS_PER_FRAME = 4;
+constexpr uint32_t DRAW_BUDGET_US = 2000;
+constexpr uint32_t DRAW_FRAME_MS = 16;
+// Pre-render the walls into an image once they are drawn: Off | Bits1 | Bits2 | Bits4 | Bits8 | RGB565
+// Costs rasterBytes() of RAM per level (twice while the next level is built), see printRasterReport
+constexpr WallRaster WALL_RASTER = WallRaster::Off;
+// Prints display flushes and ball invalidations once a second, build with MAZE_BALL_OBJECT=1 to compare
+constexpr bool PRINT_RENDER_STATS = false;
 
-static Maze* createMaze(MazeType t) {
+// Level seeds are drawn from this, so a whole session replays from its first seed
+MazeRandom level_rng;
+
+// Fixed physics steps per second, each step is one collision pass. Lower it to save CPU,
+// the motion stays the same apart from a coarser collision response
+constexpr uint16_t PHYSICS_HZ = BALL_PHYSICS_HZ;
+// Substep: up to 24 short moves per step, Swept: one sweep to the first wall, exact at any speed,
+// Indexed: substeps against a bucket grid of the walls (circular mazes, corners of neighbouring cells included),
+// DistanceField: substeps against a distance field of the drawn walls, four table reads for any maze shape
+constexpr CollisionMode COLLISION_MODE = CollisionMode::Substep;
+// Balls in play. More than one runs them all in a BallSwarm where they bump into each other,
+// the first one is the player's: the hints follow it and it has to reach the exit
+constexpr int BALL_COUNT = 1;
+constexpr float BALL_RADIUS = 5.0f;
+
+// Next level is generated and drawn off-screen in slices of this many microseconds per loop
+constexpr uint32_t PIPELINE_BUDGET_US = 2000;
+// Screen change when the exit is reached, LV_SCR_LOAD_ANIM_NONE swaps within a single frame
+constexpr lv_scr_load_anim_t LEVEL_TRANSITION = LV_SCR_LOAD_ANIM_NONE;
+constexpr uint32_t LEVEL_TRANSITION_MS = 0;
+
+LevelPipeline next_level;
+FrameTimer frame_timer;
+MazeHint hint;
+FlushMonitor flush_monitor;
+uint32_t last_render_report = 0;
+
+static MazeId mazeIdFor(MazeType t, uint32_t seed) {
+    MazeId id;
+    id.type = t;
+    id.seed = seed;
+    id.exit_placement = ExitChoice;
     switch (t) {
         case MazeType::Rectangular:
-            // rows, cols, cell_size, offset
+            // cols, rows, cell_size, offset
             // Given we usually want a centered square maze of size nxn we can calculate cell size as 
             // cell size = [screen size (240) - 2*offset] / n or just 160 / n
-            return new RectangularMaze(10, 10, 16, 40);
+            id.dims[0] = 10; id.dims[1] = 10; id.dims[2] = 16; id.dims[3] = 40;
+            break;
         case MazeType::Circular:
             // rings, sectors, spacing
             // if we want n rings we can caulculate rign spacing as
             // [screen size (240) / 2] / n ==>  120/n - 1 (for some extra space for the last ring)
             // all the way down until ring spacing == 7
-            return new CircularMaze(10, 16, 11);
+            id.dims[0] = 10; id.dims[1] = 16; id.dims[2] = 11;
+            // adaptive: sectors is the count of the innermost ring, 6 grows to 48 at the rim
+            if (CIRCULAR_ADAPTIVE) { id.dims[1] = 6; id.dims[3] = 1; }
+            break;
+        case MazeType::Hex:
+            // cols, rows, hexagon radius, odd rows stick out half a cell to the right
+            id.dims[0] = 9; id.dims[1] = 9; id.dims[2] = 9;
+            break;
+        case MazeType::Triangle:
+            // cols, rows, side length, width is (cols + 1) * side / 2
+            id.dims[0] = 15; id.dims[1] = 8; id.dims[2] = 20;
+            break;
         case MazeType::Clock:
         default:
             // hours, ring spacing
-            return new MazeClock(6, 12);
+            id.dims[0] = 6; id.dims[1] = 12;
+            break;
+    }
+    return id;
+}
+
+static MazeId nextMazeId() {
+    MazeId id = mazeIdFor(MazeChoice, level_rng.next());
+
+    // Print the id so the level can be shared or replayed with createMaze(MazeId)
+    char id_str[MazeId::STRING_SIZE];
+    id.toString(id_str);
+    Serial.print("maze id: ");
+    Serial.println(id_str);
+    return id;
+}
+
+static void printStats(const Maze* m) {
+    const MazeStats& st = m->getStats();
+    Serial.print("solution length: ");
+    Serial.print(st.solution_length);
+    Serial.print(", dead ends: ");
+    Serial.print(st.dead_ends);
+    Serial.print(", branching: ");
+    Serial.println(st.branching_factor);
+
+    // All walls live in one layer object, build with MAZE_WALL_OBJECTS=1 to compare against an lv_line per wall
+    const WallLayer& walls = m->wallLayer();
+    Serial.print("walls: ");
+    Serial.print(walls.lineCount());
+    Serial.print(", points: ");
+    Serial.print(walls.pointCount());
+    Serial.print(", layer bytes: ");
+    Serial.println(walls.bytes());
+    if (m->wallField().lineCount() > 0) {
+        Serial.print("wall field bytes: ");
+        Serial.println(m->wallField().bytes());
+    }
+    if (MazeChoice == MazeType::Rectangular) {
+        // cell edges per drawn line after collinear walls are merged
+        Serial.print("wall merge ratio: ");
+        Serial.println(static_cast<const RectangularMaze*>(m)->wallMergeRatio());
+    }
+#if LV_MEM_CUSTOM == 0
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    Serial.print("lvgl heap used: ");
+    Serial.print(mon.total_size - mon.free_size);
+    Serial.print(", peak: ");
+    Serial.println(mon.max_used);
+#endif
+}
+
+static void printRasterReport() {
+    // Buffer size of the pre-rendered walls for this screen at every depth
+    static const WallRaster formats[] = { WallRaster::Bits1, WallRaster::Bits2, WallRaster::Bits4,
+                                          WallRaster::Bits8, WallRaster::RGB565 };
+    static const char* names[] = { "1 bpp", "2 bpp", "4 bpp", "8 bpp", "RGB565" };
+    for (int i = 0; i < 5; ++i) {
+        Serial.print("wall raster ");
+        Serial.print(names[i]);
+        Serial.print(": ");
+        Serial.print(WallLayer::rasterBytes(formats[i], SCREEN_WIDTH, SCREEN_HEIGHT));
+        Serial.println(" bytes");
+    }
+}
+
+static void printRenderStats() {
+    // Counts are over the last second, a resting ball should show no flushes at all
+    Serial.print("flushes/s: ");
+    Serial.print(flush_monitor.flushes());
+    Serial.print(", refreshes/s: ");
+    Serial.print(flush_monitor.refreshes());
+    Serial.print(", flushed px/s: ");
+    Serial.print(flush_monitor.pixels());
+    if (ball) {
+        Serial.print(", ball invalidated px/s: ");
+        Serial.print(ball->invalidatedPixels());
+        ball->resetRenderStats();
+    }
+    if (swarm) {
+        Serial.print(", balls invalidated px/s: ");
+        Serial.print(swarm->invalidatedPixels());
+        Serial.print(", ball pair tests/s: ");
+        Serial.print(swarm->pairTests());
+        Serial.print(", contacts/s: ");
+        Serial.print(swarm->contacts());
+        swarm->resetStats();
+    }
+    if (ImuBus* bus = imu.bus()) {
+        // One status read and one or two bursts a frame, instead of 33 register reads
+        Serial.print(", imu i2c transactions/s: ");
+        Serial.print(bus->transactions());
+        Serial.print(", imu i2c bytes/s: ");
+        Serial.print(bus->bytes());
+        bus->resetStats();
+    }
+    Serial.println();
+    flush_monitor.reset();
+}
+
+static void printWallFieldReport(Maze& m) {
+    // Levels after the first get their field from the pipeline, a bit per loop
+    uint32_t t0 = micros();
+    m.wallFieldStep(UINT32_MAX);
+    Serial.print("wall field build us: ");
+    Serial.print(micros() - t0);
+    Serial.print(", bytes: ");
+    Serial.print(m.wallField().bytes());
+
+    // Query cost over a spread of points on the screen
+    constexpr int QUERIES = 1000;
+    int near_walls = 0;
+    float d, nx, ny;
+    t0 = micros();
+    for (int i = 0; i < QUERIES; ++i) {
+        if (m.wallField().nearest((i * 37) % SCREEN_WIDTH, (i * 61) % SCREEN_HEIGHT, d, nx, ny)) ++near_walls;
+    }
+    Serial.print(", query ns: ");
+    Serial.print((micros() - t0) * 1000.0f / QUERIES);
+    Serial.print(", queries near a wall: ");
+    Serial.println(near_walls);
+}
+
+static void onMazeDrawn(Maze& m, void*) {
+    if (WALL_RASTER != WallRaster::Off) {
+        uint32_t t0 = micros();
+        m.wallLayer().rasterize(WALL_RASTER);
+        Serial.print("wall raster us: ");
+        Serial.println(micros() - t0);
+    }
+    if (COLLISION_MODE == CollisionMode::DistanceField) printWallFieldReport(m);
+    printStats(&m);
+}
+
+static void spawnBalls(lv_obj_t* screen) {
+    lv_point_t spawn = maze->getBallSpawnPixel();
+    // a replay starts the level and the ball's clock at the same time
+    const uint32_t start_us = session_clock.startLevel(maze->getId());
+    if (BALL_COUNT <= 1) {
+        ball = new Ball(screen, spawn.x, spawn.y, BALL_RADIUS);
+        ball->setPhysicsRate(PHYSICS_HZ);
+        ball->restartClock(start_us);
+        return;
+    }
+    // the player's ball at the spawn, the others in random cells away from the exit
+    swarm = new BallSwarm(screen, BALL_COUNT, BALL_RADIUS);
+    swarm->setPhysicsRate(PHYSICS_HZ);
+    swarm->restartClock(start_us);
+    swarm->add(spawn.x, spawn.y);
+    while (swarm->count() < BALL_COUNT) {
+        const int cell = level_rng.next() % maze->cellCount();
+        if (cell == maze->exitCell()) continue;
+        const lv_point_t p = maze->cellCenterPixel(cell);
+        swarm->add(p.x, p.y);
     }
 }
 
-static void regenerateCurrentMaze() {
-    // Delete ball first
+static void deleteBalls() {
     if (ball) { delete ball; ball = nullptr; }
+    if (swarm) { delete swarm; swarm = nullptr; }
+}
+
+static void switchToNextLevel() {
+    // Level should be ready by now, finish it here if the exit was reached very quickly
+    if (!next_level.isReady()) next_level.finish();
+
+    lv_obj_t* screen = nullptr;
+    Maze* next = next_level.take(&screen);
+    if (!next) return;
 
-    // Clear old maze visuals from the screen
-    lv_obj_t* screen = lv_scr_act();
-    lv_obj_clean(screen);
+    // Delete ball first, then swap screens, the old screen is deleted along with its walls (and hint dots)
+    deleteBalls();
+    hint.detach(/*delete_objects=*/false);
+    lv_scr_load_anim(screen, LEVEL_TRANSITION, LEVEL_TRANSITION_MS, 0, /*auto_del=*/true);
 
-    // Recreate the same type of maze
-    if (maze) { delete maze; maze = nullptr; }
-    maze = createMaze(MazeChoice);
-    maze->generate();
-    maze->draw(screen, /*animate=*/true);
+    if (maze) delete maze;
+    maze = next;
+    printStats(maze);
+
+    if (SHOW_HINTS) hint.attach(*maze, screen, HINT_DOTS);
 
     // Spawn a new ball at the new maze’s spawn
-    lv_point_t spawn = maze->getBallSpawnPixel();
-    ball = new Ball(screen, spawn.x, spawn.y, /*radius=*/5.0f);
+    spawnBalls(screen);
+    maze->setCollisionMode(COLLISION_MODE);
+
+    // Start building the level after this one
+    next_level.prepare(nextMazeId());
+}
+
+static void reportTransition(uint32_t worst_before_us, uint32_t event_us, uint32_t worst_after_us, void*) {
+    Serial.print("level switch frame us: before ");
+    Serial.print(worst_before_us);
+    Serial.print(", switch ");
+    Serial.print(event_us);
+    Serial.print(", after ");
+    Serial.println(worst_after_us);
 }
 
 void setup() {
@@ -77,8 +329,9 @@ void setup() {
 
     lv_init();
     lv_xiao_disp_init();
-    // Use pin noise for random number generation
-    randomSeed(analogRead(A0));
+    if (PRINT_RENDER_STATS) flush_monitor.attach(lv_disp_get_default());
+    // Use pin noise for the session seed, every maze after that is reproducible from its id
+    level_rng.setSeed(analogRead(A0));
 
     // Create a main screen
     lv_obj_t* mainScreen = lv_obj_create(nullptr);
@@ -86,40 +339,62 @@ void setup() {
     lv_scr_load(mainScreen);
     lv_obj_set_style_bg_color(mainScreen, lv_color_black(), 0);
 
-    // Initialize the IMU
+    // Initialize the IMU, through the trace recorder if one is wanted
+    if (RECORD_TRACE) {
+        imu.setSource(&recording_imu);
+        session_clock.record(&trace);
+    }
     imu.begin();
 
     // Choose which maze to create
-    maze = createMaze(MazeChoice);
+    maze = createMaze(nextMazeId());
 
     // Generate and draw the maze
     if (maze) {
         maze->generate();
-        // Animate the drawing, or set to false if you want instant maze generation
-        maze->draw(mainScreen, false);
+        // Animate the drawing (see ANIMATE_DRAW), or draw it all right here
+        maze->drawAnimation().configure(DRAW_WALLS_PER_FRAME, DRAW_BUDGET_US, DRAW_FRAME_MS);
+        maze->drawAnimation().setDoneCallback(onMazeDrawn, nullptr);
+        maze->draw(mainScreen, ANIMATE_DRAW);
+        if (!maze->isDrawing()) onMazeDrawn(*maze, nullptr);
 
         lv_point_t spawn = maze->getBallSpawnPixel();
         Serial.print("spawn location: ");
         Serial.println(spawn.x);
         Serial.println(spawn.y);
-        // choose your ball radius; if you keep default 5.0, pass that here to set the member correctly
-        ball = new Ball(mainScreen, spawn.x, spawn.y, 5.0f);
+        if (SHOW_HINTS) hint.attach(*maze, mainScreen, HINT_DOTS);
+        // choose your ball radius with BALL_RADIUS
+        spawnBalls(mainScreen);
+        maze->setCollisionMode(COLLISION_MODE);
 
     }
+
+    // Next level is built in the background while this one is played
+    printRasterReport();
+    next_level.setWallRaster(WALL_RASTER);
+    next_level.setWallField(COLLISION_MODE == CollisionMode::DistanceField);
+    next_level.prepare(nextMazeId());
+    frame_timer.setReportCallback(reportTransition, nullptr);
 }
 
 void loop() {
     float roll = 0.0f, pitch = 0.0f;
+    frame_timer.tick();
+    session_clock.frame();
 
-    // Check if 60 seconds have passed since the last update
-    if (millis() - last_time_update > 60000) {
+    // Poll the RTC every second, the clock hands only redraw when the minute actually changed
+    if (millis() - last_time_update > CLOCK_POLL_MS) {
         last_time_update = millis();
-        if (maze) {
-            maze->updateTime(); // Call the new update function
+        if (maze && maze->updateTime()) {
             Serial.println("Time updated");
         }
     }
 
+    if (PRINT_RENDER_STATS && millis() - last_render_report >= 1000) {
+        last_render_report = millis();
+        printRenderStats();
+    }
+
     // Read IMU data if motion is detected
     if (imu.read()) {
         imu.getRollAndPitch(roll, pitch);
@@ -127,24 +402,42 @@ void loop() {
 
     // Update ball position based on IMU data
     if (ball) {
-        ball->updatePhysics(roll, pitch);
-        maze->stepBallWithCollisions(*ball,
-            /*max_step_px=*/ ball->getRadius() * 0.5f,  // tune: smaller => safer
-            /*max_substeps=*/ 24                         // cap for performance
-        );
+        // As many fixed steps as the time since the last frame holds, then draw in between
+        const int steps = ball->advanceClock(session_clock.now());
+        for (int i = 0; i < steps; ++i) {
+            ball->updatePhysics(roll, pitch);
+            maze->stepBallWithCollisions(*ball,
+                /*max_step_px=*/ ball->getRadius() * 0.5f,  // tune: smaller => safer
+                /*max_substeps=*/ 24                         // cap for performance
+            );
+        }
         ball->draw();
+        hint.update(ball->getX(), ball->getY());
+    }
+    if (swarm) {
+        const int steps = swarm->advanceClock(session_clock.now());
+        for (int i = 0; i < steps; ++i) {
+            swarm->updatePhysics(roll, pitch);
+            swarm->collideBalls();
+            maze->stepSwarmWithCollisions(*swarm, swarm->getRadius() * 0.5f, 24);
+        }
+        swarm->draw();
+        hint.update(swarm->getX(0), swarm->getY(0));
     }
 
-    // check if exit is reached
-    const float tol = ball->getRadius() + 4.0f;
+    // check if exit is reached by the player's ball
+    const float player_x = swarm ? swarm->getX(0) : ball->getX();
+    const float player_y = swarm ? swarm->getY(0) : ball->getY();
+    const float tol = BALL_RADIUS + 4.0f;
 
-    if (maze->isAtExit(ball->getX(), ball->getY(), tol)) {
-        regenerateCurrentMaze();
-        // optional: brief pause to avoid instant retrigger
-        delay(40);
+    if (maze->isAtExit(player_x, player_y, tol)) {
+        frame_timer.markEvent();
+        switchToNextLevel();
+        lv_timer_handler();
         return; // skip the rest of this loop iteration
     }
 
+    next_level.service(PIPELINE_BUDGET_US);
     lv_timer_handler();
     delay(5);
 }
\ No newline at end of file